@@ -30,7 +30,8 @@ typedef enum {
     ARGB_DMA_NO_PWM,           ///< Пин не поддерживает PWM
     ARGB_DMA_NO_DMA,           ///< Таймер не имеет DMA для этого канала
     ARGB_DMA_UNSUPPORTED_TIM,  ///< Таймер не поддерживается
-    ARGB_DMA_ERR               ///< Общая ошибка
+    ARGB_DMA_ERR,              ///< Общая ошибка
+    ARGB_DMA_CONFLICT          ///< Таймер или DMA стрим заняты другой лентой (ARGB_AllocateDMA)
 } ARGB_DMA_Result_t;
 
 // ============================================================================
@@ -205,58 +206,295 @@ static inline const char* ARGB_DMA_ResultString(ARGB_DMA_Result_t res)
         case ARGB_DMA_NO_PWM:          return "NO_PWM (pin doesn't support PWM)";
         case ARGB_DMA_NO_DMA:          return "NO_DMA (timer/channel has no DMA)";
         case ARGB_DMA_UNSUPPORTED_TIM: return "UNSUPPORTED_TIM";
+        case ARGB_DMA_CONFLICT:        return "CONFLICT (timer/DMA stream shared with another strip)";
         default:                       return "ERROR";
     }
 }
 
+/**
+ * @brief  Ширина элемента PWM буфера, которую ARGB_Setup_Ex() выставит для пина, байт
+ * @note   Для ARGB_STRIP_DEF_W() / ARGB_ArenaStrip(): буфер ленты на 16-битном таймере
+ *         F4 вдвое меньше, на channel DMA (F0/F1/F3/L4/G4) вчетверо
+ */
+static inline uint8_t ARGB_PwmWidth(const ARGB_PinConfig_t* cfg)
+{
+    #if defined(DMA_SxCR_EN)
+    return cfg->is_32bit_tim ? 4 : 2;   // Stream DMA: MSIZE = PSIZE в direct mode
+    #else
+    (void)cfg;
+    return 1;                           // Channel DMA дополняет байт нулями до CCR
+    #endif
+}
+
 // ============================================================================
-// Глобальные handles (используются ARGB_Setup и IRQ Handler)
+// Распределение DMA стримов между несколькими лентами
 // ============================================================================
-static TIM_HandleTypeDef  ARGB_htim;
-static DMA_HandleTypeDef  ARGB_hdma;
-static ARGB_PinConfig_t   ARGB_cfg;
+#ifndef ARGB_ALLOC_MAX_PINS
+#define ARGB_ALLOC_MAX_PINS 8   ///< Лент в одном ARGB_AllocateDMA()
+#endif
+#define ARGB_ALLOC_MAX_CAND 8   ///< Вариантов TIM/канал/стрим на пин
+
+#if defined(STM32F4xx)
+/// Вариант подключения пина: запись PinMap_PWM + запись ARGB_DMA_MAP
+typedef struct {
+    uint16_t pwm;   ///< Индекс в PinMap_PWM
+    uint8_t  dma;   ///< Индекс в ARGB_DMA_MAP
+} ARGB_DMA_Cand_t;
+
+/// Состояние перебора ARGB_AllocateDMA()
+typedef struct {
+    ARGB_DMA_Cand_t cand[ARGB_ALLOC_MAX_PINS][ARGB_ALLOC_MAX_CAND];
+    uint8_t  n_cand[ARGB_ALLOC_MAX_PINS];
+    uint8_t  n;
+    int8_t   pick[ARGB_ALLOC_MAX_PINS];  ///< Текущий вариант, -1 - лента не параллельна остальным
+    int8_t   best[ARGB_ALLOC_MAX_PINS];
+    int16_t  best_score;
+} ARGB_DMA_Alloc_t;
+
+/** @brief  Канал записи PinMap_PWM (TIM_CHANNEL_x), 0 - не подходит (CHxN инвертирован) */
+static inline uint8_t ARGB_PwmChannel(const PinMap* map, uint32_t* channel)
+{
+    if (STM_PIN_INVERTED(map->function)) return 0;
+    switch (STM_PIN_CHANNEL(map->function)) {
+        case 1: *channel = TIM_CHANNEL_1; return 1;
+        case 2: *channel = TIM_CHANNEL_2; return 1;
+        case 3: *channel = TIM_CHANNEL_3; return 1;
+        case 4: *channel = TIM_CHANNEL_4; return 1;
+        default: return 0;
+    }
+}
+
+/** @brief  Стрим на DMA2 (DMA1 обслуживает ещё и все APB1 таймеры/SPI/USART) */
+static inline uint8_t ARGB_IsDMA2(const ARGB_DMA_Map_t* dma_map)
+{
+    #ifdef DMA2
+    return dma_map->dma == DMA2;
+    #else
+    (void)dma_map;
+    return 0;
+    #endif
+}
 
 /**
- * @brief  Универсальная инициализация ARGB по номеру пина
+ * @brief  Все варианты пина: его PWM каналы (включая PA_0_ALT1 и т.п.) x DMA стримы канала
+ * @note   Для high-rate лент первыми идут стримы DMA2, иначе порядок таблиц
+ *         (первый вариант = ARGB_AnalyzePin())
+ * @return ARGB_DMA_OK / ARGB_DMA_NO_PWM / ARGB_DMA_NO_DMA
+ */
+static inline ARGB_DMA_Result_t ARGB_PinCandidates(uint32_t arduino_pin, uint8_t high_rate,
+                                                   ARGB_DMA_Cand_t* cand, uint8_t* n_cand)
+{
+    uint8_t has_pwm = 0;
+    *n_cand = 0;
+    PinName pn = digitalPinToPinName(arduino_pin);
+    if (pn == NC) return ARGB_DMA_ERR;
+    
+    for (uint8_t pass = 0; pass < 2; pass++) {
+        for (uint16_t i = 0; PinMap_PWM[i].pin != NC; i++) {
+            const PinMap* map = &PinMap_PWM[i];
+            if (((uint32_t)map->pin & ~(uint32_t)ALTX_MASK) != (uint32_t)pn) continue;
+            uint32_t channel;
+            if (!ARGB_PwmChannel(map, &channel)) continue;
+            has_pwm = 1;
+            for (uint8_t d = 0; ARGB_DMA_MAP[d].tim != NULL; d++) {
+                const ARGB_DMA_Map_t* dma_map = &ARGB_DMA_MAP[d];
+                if (dma_map->tim != (TIM_TypeDef*)map->peripheral || dma_map->channel != channel) continue;
+                // Проход 0 - предпочтительные стримы, проход 1 - остальные
+                if ((high_rate && !ARGB_IsDMA2(dma_map)) != pass) continue;
+                if (*n_cand < ARGB_ALLOC_MAX_CAND) {
+                    cand[*n_cand].pwm = i;
+                    cand[*n_cand].dma = d;
+                    (*n_cand)++;
+                }
+            }
+        }
+    }
+    if (*n_cand) return ARGB_DMA_OK;
+    return has_pwm ? ARGB_DMA_NO_DMA : ARGB_DMA_NO_PWM;
+}
+
+/** @brief  Заполняет конфигурацию по выбранному варианту (как ARGB_AnalyzePin()) */
+static inline void ARGB_CandConfig(const ARGB_DMA_Cand_t* c, ARGB_PinConfig_t* cfg)
+{
+    const PinMap* map = &PinMap_PWM[c->pwm];
+    const ARGB_DMA_Map_t* dma_map = &ARGB_DMA_MAP[c->dma];
+    PinName pn = (PinName)((uint32_t)map->pin & ~(uint32_t)ALTX_MASK);
+    
+    memset(cfg, 0, sizeof(ARGB_PinConfig_t));
+    cfg->gpio_port = get_GPIO_Port(STM_PORT(pn));
+    cfg->gpio_pin = STM_GPIO_PIN(pn);
+    cfg->tim = dma_map->tim;
+    cfg->tim_channel = dma_map->channel;
+    cfg->tim_af = STM_PIN_AFNUM(map->function);
+    cfg->tim_dma_cc = (dma_map->channel == TIM_CHANNEL_1) ? TIM_DMA_CC1 :
+                      (dma_map->channel == TIM_CHANNEL_2) ? TIM_DMA_CC2 :
+                      (dma_map->channel == TIM_CHANNEL_3) ? TIM_DMA_CC3 : TIM_DMA_CC4;
+    #if defined(TIM2)
+    if (cfg->tim == TIM2) cfg->is_32bit_tim = 1;
+    #endif
+    #if defined(TIM5)
+    if (cfg->tim == TIM5) cfg->is_32bit_tim = 1;
+    #endif
+    cfg->dma_stream = dma_map->stream;
+    cfg->dma_channel = dma_map->dma_ch;
+    cfg->dma_irqn = dma_map->irqn;
+}
+
+/**
+ * @brief  Перебор с отсечением: максимум параллельных лент, затем минимум "штрафа"
+ * @note   Параллельные ленты не делят ни таймер (ARGB_Show() перезапускает его
+ *         счётчик), ни DMA стрим. Штраф варианта - его номер в списке пина.
+ */
+static inline void ARGB_AllocSearch(ARGB_DMA_Alloc_t* a, uint8_t i, uint8_t count, int16_t cost)
+{
+    if ((int16_t)((count + a->n - i) * 64 - cost) <= a->best_score) return;  // Лучше уже не будет
+    if (i == a->n) {
+        a->best_score = (int16_t)(count * 64 - cost);
+        memcpy(a->best, a->pick, sizeof(a->best));
+        return;
+    }
+    for (uint8_t k = 0; k < a->n_cand[i]; k++) {
+        const ARGB_DMA_Map_t* dk = &ARGB_DMA_MAP[a->cand[i][k].dma];
+        uint8_t busy = 0;
+        for (uint8_t j = 0; j < i && !busy; j++) {
+            if (a->pick[j] < 0) continue;
+            const ARGB_DMA_Map_t* dj = &ARGB_DMA_MAP[a->cand[j][a->pick[j]].dma];
+            busy = dj->tim == dk->tim || dj->stream == dk->stream;
+        }
+        if (busy) continue;
+        a->pick[i] = (int8_t)k;
+        ARGB_AllocSearch(a, i + 1, count + 1, cost + k);
+    }
+    a->pick[i] = -1;  // Без этой ленты
+    ARGB_AllocSearch(a, i + 1, count, cost);
+}
+#endif // STM32F4xx
+
+/**
+ * @brief  Подбирает TIM/канал/DMA стрим для набора лент без общих ресурсов
+ * @param  pins       Arduino-номера пинов
+ * @param  n          Количество, до ARGB_ALLOC_MAX_PINS
+ * @param  high_rate  Битовая маска лент (бит i - pins[i]), которым лучше отдать DMA2
+ * @param  cfg        [n] Конфигурации для ARGB_SetupConfig_Ex()
+ * @param  res        [n] ARGB_DMA_OK - лента работает параллельно со всеми остальными OK,
+ *                    ARGB_DMA_CONFLICT - делит таймер/стрим с одной из них (cfg = первый вариант),
+ *                    ARGB_DMA_NO_PWM / ARGB_DMA_NO_DMA - как в ARGB_AnalyzePin()
+ * @return Количество лент, которые могут передавать одновременно
+ * 
+ * Рассматривает все таймеры пина (PA0: TIM2_CH1 и TIM5_CH1) и все стримы канала
+ * (TIM1_CH1: DMA2_Stream1 и DMA2_Stream3), а не первую запись таблицы. Например
+ * PA0 + PB5 + PB8: TIM2_CH1 и TIM3_CH2 оба хотят DMA1_Stream5 - PA0 уходит на TIM5.
+ */
+static inline uint8_t ARGB_AllocateDMA(const uint32_t* pins, uint8_t n, uint32_t high_rate,
+                                       ARGB_PinConfig_t* cfg, ARGB_DMA_Result_t* res)
+{
+    uint8_t count = 0;
+    if (n > ARGB_ALLOC_MAX_PINS) n = ARGB_ALLOC_MAX_PINS;
+    #if defined(STM32F4xx)
+    ARGB_DMA_Alloc_t a;
+    memset(&a, 0, sizeof(a));
+    a.n = n;
+    a.best_score = -1;
+    for (uint8_t i = 0; i < n; i++) {
+        res[i] = ARGB_PinCandidates(pins[i], (high_rate >> i) & 1, a.cand[i], &a.n_cand[i]);
+        a.pick[i] = a.best[i] = -1;
+    }
+    ARGB_AllocSearch(&a, 0, 0, 0);
+    
+    for (uint8_t i = 0; i < n; i++) {
+        memset(&cfg[i], 0, sizeof(ARGB_PinConfig_t));
+        if (res[i] != ARGB_DMA_OK) continue;
+        if (a.best[i] >= 0) {
+            ARGB_CandConfig(&a.cand[i][a.best[i]], &cfg[i]);
+            count++;
+        } else {
+            ARGB_CandConfig(&a.cand[i][0], &cfg[i]);  // Работает, но не одновременно с соседом
+            res[i] = ARGB_DMA_CONFLICT;
+        }
+    }
+    #else
+    for (uint8_t i = 0; i < n; i++) {
+        memset(&cfg[i], 0, sizeof(ARGB_PinConfig_t));
+        res[i] = ARGB_DMA_NO_DMA;
+    }
+    (void)pins; (void)high_rate;
+    #endif
+    return count;
+}
+
+// ============================================================================
+// Handles ленты (TIM/DMA у каждой ленты свои)
+// ============================================================================
+typedef struct {
+    ARGB_PinConfig_t    cfg;            ///< Результат ARGB_AnalyzePin()
+    TIM_HandleTypeDef   htim;           ///< Таймер ленты
+    DMA_HandleTypeDef   hdma;           ///< DMA ленты
+} ARGB_AutoHW_t;
+
+/// Handles ленты по умолчанию (ARGB_Setup / ARGB_DMA_IRQHandler)
+static ARGB_AutoHW_t ARGB_hw;
+
+static inline ARGB_DMA_Result_t ARGB_SetupConfig_Ex(ARGB_Strip* strip, ARGB_AutoHW_t* hw, const ARGB_PinConfig_t* cfg);
+
+/**
+ * @brief  Инициализация отдельной ленты по номеру пина
+ * @param  strip        Лента (ARGB_STRIP_DEF)
+ * @param  hw           Handles этой ленты, должны жить всё время работы
  * @param  arduino_pin  Любой PWM-совместимый пин (PA0, PB4, etc.)
  * @return ARGB_DMA_OK при успехе
  * 
  * Функция автоматически:
  *   1. Определяет какой TIM/Channel/DMA нужен для этого пина
  *   2. Настраивает GPIO, Timer, DMA
- *   3. Вызывает ARGB_Attach() и ARGB_Init()
+ *   3. Вызывает ARGB_Attach_Ex() и ARGB_Init_Ex()
  */
-static inline ARGB_DMA_Result_t ARGB_Setup(uint32_t arduino_pin)
+static inline ARGB_DMA_Result_t ARGB_Setup_Ex(ARGB_Strip* strip, ARGB_AutoHW_t* hw, uint32_t arduino_pin)
 {
-    ARGB_DMA_Result_t res = ARGB_AnalyzePin(arduino_pin, &ARGB_cfg);
+    ARGB_PinConfig_t cfg;
+    ARGB_DMA_Result_t res = ARGB_AnalyzePin(arduino_pin, &cfg);
     if (res != ARGB_DMA_OK) return res;
+    return ARGB_SetupConfig_Ex(strip, hw, &cfg);
+}
+
+/**
+ * @brief  Инициализация ленты по готовой конфигурации (ARGB_AllocateDMA())
+ * @param  strip  Лента (ARGB_STRIP_DEF)
+ * @param  hw     Handles этой ленты, должны жить всё время работы
+ * @param  cfg    Конфигурация пина, копируется в hw->cfg
+ * @return ARGB_DMA_OK при успехе
+ */
+static inline ARGB_DMA_Result_t ARGB_SetupConfig_Ex(ARGB_Strip* strip, ARGB_AutoHW_t* hw, const ARGB_PinConfig_t* cfg)
+{
+    if (cfg->tim == NULL || cfg->dma_stream == NULL) return ARGB_DMA_ERR;
+    hw->cfg = *cfg;
     
+    #ifndef ARGB_SIM
     // GPIO clock
     #ifdef GPIOA
-    if (ARGB_cfg.gpio_port == GPIOA) __HAL_RCC_GPIOA_CLK_ENABLE();
+    if (hw->cfg.gpio_port == GPIOA) __HAL_RCC_GPIOA_CLK_ENABLE();
     #endif
     #ifdef GPIOB
-    if (ARGB_cfg.gpio_port == GPIOB) __HAL_RCC_GPIOB_CLK_ENABLE();
+    if (hw->cfg.gpio_port == GPIOB) __HAL_RCC_GPIOB_CLK_ENABLE();
     #endif
     #ifdef GPIOC
-    if (ARGB_cfg.gpio_port == GPIOC) __HAL_RCC_GPIOC_CLK_ENABLE();
+    if (hw->cfg.gpio_port == GPIOC) __HAL_RCC_GPIOC_CLK_ENABLE();
     #endif
     
     // Timer clock
     #ifdef TIM1
-    if (ARGB_cfg.tim == TIM1) __HAL_RCC_TIM1_CLK_ENABLE();
+    if (hw->cfg.tim == TIM1) __HAL_RCC_TIM1_CLK_ENABLE();
     #endif
     #ifdef TIM2
-    if (ARGB_cfg.tim == TIM2) __HAL_RCC_TIM2_CLK_ENABLE();
+    if (hw->cfg.tim == TIM2) __HAL_RCC_TIM2_CLK_ENABLE();
     #endif
     #ifdef TIM3
-    if (ARGB_cfg.tim == TIM3) __HAL_RCC_TIM3_CLK_ENABLE();
+    if (hw->cfg.tim == TIM3) __HAL_RCC_TIM3_CLK_ENABLE();
     #endif
     #ifdef TIM4
-    if (ARGB_cfg.tim == TIM4) __HAL_RCC_TIM4_CLK_ENABLE();
+    if (hw->cfg.tim == TIM4) __HAL_RCC_TIM4_CLK_ENABLE();
     #endif
     #ifdef TIM5
-    if (ARGB_cfg.tim == TIM5) __HAL_RCC_TIM5_CLK_ENABLE();
+    if (hw->cfg.tim == TIM5) __HAL_RCC_TIM5_CLK_ENABLE();
     #endif
     
     // DMA clock
@@ -267,83 +505,114 @@ static inline ARGB_DMA_Result_t ARGB_Setup(uint32_t arduino_pin)
     
     // GPIO
     GPIO_InitTypeDef gpio = {0};
-    gpio.Pin = ARGB_cfg.gpio_pin;
+    gpio.Pin = hw->cfg.gpio_pin;
     gpio.Mode = GPIO_MODE_AF_PP;
     gpio.Pull = GPIO_NOPULL;
     gpio.Speed = GPIO_SPEED_FREQ_HIGH;
-    gpio.Alternate = ARGB_cfg.tim_af;
-    HAL_GPIO_Init(ARGB_cfg.gpio_port, &gpio);
+    gpio.Alternate = hw->cfg.tim_af;
+    HAL_GPIO_Init(hw->cfg.gpio_port, &gpio);
+    #endif
     
     // Timer
-    ARGB_htim.Instance = ARGB_cfg.tim;
-    ARGB_htim.Init.Prescaler = 0;
-    ARGB_htim.Init.CounterMode = TIM_COUNTERMODE_UP;
-    ARGB_htim.Init.Period = 104;
-    ARGB_htim.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
-    HAL_TIM_PWM_Init(&ARGB_htim);
+    hw->htim.Instance = hw->cfg.tim;
+    #ifndef ARGB_SIM
+    hw->htim.Init.Prescaler = 0;
+    hw->htim.Init.CounterMode = TIM_COUNTERMODE_UP;
+    hw->htim.Init.Period = 104;
+    hw->htim.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+    HAL_TIM_PWM_Init(&hw->htim);
     
     TIM_OC_InitTypeDef oc = {0};
     oc.OCMode = TIM_OCMODE_PWM1;
     oc.Pulse = 0;
     oc.OCPolarity = TIM_OCPOLARITY_HIGH;
-    HAL_TIM_PWM_ConfigChannel(&ARGB_htim, &oc, ARGB_cfg.tim_channel);
-    
-    // DMA (автоматически WORD для 32-bit таймеров, HALFWORD для 16-bit)
-    ARGB_hdma.Instance = ARGB_cfg.dma_stream;
-    ARGB_hdma.Init.Channel = ARGB_cfg.dma_channel;
-    ARGB_hdma.Init.Direction = DMA_MEMORY_TO_PERIPH;
-    ARGB_hdma.Init.PeriphInc = DMA_PINC_DISABLE;
-    ARGB_hdma.Init.MemInc = DMA_MINC_ENABLE;
-    ARGB_hdma.Init.PeriphDataAlignment = ARGB_cfg.is_32bit_tim ? DMA_PDATAALIGN_WORD : DMA_PDATAALIGN_HALFWORD;
-    ARGB_hdma.Init.MemDataAlignment = ARGB_cfg.is_32bit_tim ? DMA_MDATAALIGN_WORD : DMA_MDATAALIGN_HALFWORD;
-    ARGB_hdma.Init.Mode = DMA_NORMAL;
-    ARGB_hdma.Init.Priority = DMA_PRIORITY_HIGH;
-    ARGB_hdma.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
-    HAL_DMA_Init(&ARGB_hdma);
+    HAL_TIM_PWM_ConfigChannel(&hw->htim, &oc, hw->cfg.tim_channel);
+    #endif
+    
+    // DMA (автоматически WORD для 32-bit таймеров, HALFWORD для 16-bit).
+    // Ширина элемента PWM буфера = MemDataAlignment = ARGB_PwmWidth(), ARGB_Attach() берёт её отсюда.
+    const uint8_t pwm_width = ARGB_PwmWidth(&hw->cfg);
+    hw->hdma.Instance = hw->cfg.dma_stream;
+    hw->hdma.Init.Channel = hw->cfg.dma_channel;
+    hw->hdma.Init.Direction = DMA_MEMORY_TO_PERIPH;
+    hw->hdma.Init.PeriphInc = DMA_PINC_DISABLE;
+    hw->hdma.Init.MemInc = DMA_MINC_ENABLE;
+    hw->hdma.Init.PeriphDataAlignment = hw->cfg.is_32bit_tim ? DMA_PDATAALIGN_WORD : DMA_PDATAALIGN_HALFWORD;
+    hw->hdma.Init.MemDataAlignment = pwm_width == 4 ? DMA_MDATAALIGN_WORD :
+                                     pwm_width == 2 ? DMA_MDATAALIGN_HALFWORD : DMA_MDATAALIGN_BYTE;
+    #if defined(ARGB_USE_STREAMING) && ARGB_USE_STREAMING
+    hw->hdma.Init.Mode = DMA_CIRCULAR;  // Ping-pong буфер, дозаполняется в HT/TC
+    #else
+    hw->hdma.Init.Mode = DMA_NORMAL;
+    #endif
+    hw->hdma.Init.Priority = DMA_PRIORITY_HIGH;
+    hw->hdma.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+    HAL_DMA_Init(&hw->hdma);
     
     // Link DMA to Timer
-    uint32_t dma_id = (ARGB_cfg.tim_channel == TIM_CHANNEL_1) ? TIM_DMA_ID_CC1 :
-                      (ARGB_cfg.tim_channel == TIM_CHANNEL_2) ? TIM_DMA_ID_CC2 :
-                      (ARGB_cfg.tim_channel == TIM_CHANNEL_3) ? TIM_DMA_ID_CC3 : TIM_DMA_ID_CC4;
-    __HAL_LINKDMA(&ARGB_htim, hdma[dma_id], ARGB_hdma);
+    uint32_t dma_id = (hw->cfg.tim_channel == TIM_CHANNEL_1) ? TIM_DMA_ID_CC1 :
+                      (hw->cfg.tim_channel == TIM_CHANNEL_2) ? TIM_DMA_ID_CC2 :
+                      (hw->cfg.tim_channel == TIM_CHANNEL_3) ? TIM_DMA_ID_CC3 : TIM_DMA_ID_CC4;
+    __HAL_LINKDMA(&hw->htim, hdma[dma_id], hw->hdma);
     
     // Enable DMA IRQ
-    HAL_NVIC_SetPriority(ARGB_cfg.dma_irqn, 1, 0);
-    HAL_NVIC_EnableIRQ(ARGB_cfg.dma_irqn);
+    #ifndef ARGB_SIM
+    HAL_NVIC_SetPriority(hw->cfg.dma_irqn, 1, 0);
+    HAL_NVIC_EnableIRQ(hw->cfg.dma_irqn);
+    #endif
     
     // Calculate timer clock
     uint32_t tim_clk = 0;
     #if defined(TIM2) || defined(TIM3) || defined(TIM4) || defined(TIM5)
-    if (ARGB_cfg.tim == TIM2 || ARGB_cfg.tim == TIM3 || ARGB_cfg.tim == TIM4 || ARGB_cfg.tim == TIM5) {
+    if (hw->cfg.tim == TIM2 || hw->cfg.tim == TIM3 || hw->cfg.tim == TIM4 || hw->cfg.tim == TIM5) {
         tim_clk = HAL_RCC_GetPCLK1Freq();
         if ((RCC->CFGR & RCC_CFGR_PPRE1) != 0) tim_clk *= 2;
     }
     #endif
     #ifdef TIM1
-    if (ARGB_cfg.tim == TIM1) {
+    if (hw->cfg.tim == TIM1) {
         tim_clk = HAL_RCC_GetPCLK2Freq();
         if ((RCC->CFGR & RCC_CFGR_PPRE2) != 0) tim_clk *= 2;
     }
     #endif
     
     // Pass to ARGB library
-    ARGB_Attach(&ARGB_htim, ARGB_cfg.tim_channel, &ARGB_hdma, tim_clk);
-    ARGB_Init();
+    if (ARGB_Attach_Ex(strip, &hw->htim, hw->cfg.tim_channel, &hw->hdma, tim_clk) != ARGB_OK)
+        return ARGB_DMA_ERR;  // Буфер ленты уже ARGB_PwmWidth(): ARGB_STRIP_DEF_W() / DMA_SIZE_*
+    ARGB_Init_Ex(strip);
     
     return ARGB_DMA_OK;
 }
 
+/**
+ * @brief  Универсальная инициализация ARGB по номеру пина
+ * @param  arduino_pin  Любой PWM-совместимый пин (PA0, PB4, etc.)
+ * @return ARGB_DMA_OK при успехе
+ * @note   Настраивает ленту по умолчанию (ARGB_SetRGB(), ARGB_Show() ...)
+ */
+static inline ARGB_DMA_Result_t ARGB_Setup(uint32_t arduino_pin)
+{
+    return ARGB_Setup_Ex(&ARGB_DefaultStrip, &ARGB_hw, arduino_pin);
+}
+
+#ifndef ARGB_SIM
 /** 
  * @brief  Вызывайте из DMA IRQ Handler в скетче
  * @note   Имя IRQ Handler зависит от пина (выводится в Serial)
  */
 static inline void ARGB_DMA_IRQHandler(void) {
-    HAL_DMA_IRQHandler(&ARGB_hdma);
+    HAL_DMA_IRQHandler(&ARGB_hw.hdma);
 }
 
+/** @brief  То же для ленты, настроенной через ARGB_Setup_Ex() */
+static inline void ARGB_DMA_IRQHandler_Ex(ARGB_AutoHW_t* hw) {
+    HAL_DMA_IRQHandler(&hw->hdma);
+}
+#endif // ARGB_SIM (extras/sim: ARGB_Sim_RunDMA() delivers the callbacks)
+
 /** @brief  Возвращает IRQn для текущей конфигурации */
 static inline IRQn_Type ARGB_GetIRQn(void) {
-    return ARGB_cfg.dma_irqn;
+    return ARGB_hw.cfg.dma_irqn;
 }
 
 #ifdef __cplusplus
@@ -355,6 +624,7 @@ static inline IRQn_Type ARGB_GetIRQn(void) {
 
 // Forward declaration
 static inline void ARGB_PrintPinConfig(uint32_t arduino_pin);
+static inline void ARGB_PrintConfig(const ARGB_PinConfig_t* cfg);
 
 /**
  * @brief  Простая инициализация — вызвать и забыть
@@ -389,6 +659,35 @@ static inline void ARGB_PrintPinConfig(uint32_t arduino_pin)
         Serial.println(ARGB_DMA_ResultString(res));
         return;
     }
+    ARGB_PrintConfig(&cfg);
+    Serial.println();
+}
+
+/**
+ * @brief  Выводит результат ARGB_AllocateDMA() в Serial, по строке на пин
+ */
+static inline void ARGB_PrintAllocation(const uint32_t* pins, uint8_t n,
+                                        const ARGB_PinConfig_t* cfg, const ARGB_DMA_Result_t* res)
+{
+    for (uint8_t i = 0; i < n; i++) {
+        Serial.print(F("Pin "));
+        Serial.print(pins[i]);
+        Serial.print(F(": "));
+        if (res[i] != ARGB_DMA_OK && res[i] != ARGB_DMA_CONFLICT) {
+            Serial.println(ARGB_DMA_ResultString(res[i]));
+            continue;
+        }
+        ARGB_PrintConfig(&cfg[i]);
+        Serial.println(res[i] == ARGB_DMA_OK ? F(" [concurrent]") : F(" [CONFLICT - not concurrent]"));
+    }
+}
+
+/**
+ * @brief  Выводит конфигурацию в Serial без перевода строки: PA0 -> TIM2_CH1 (32-bit) -> DMA1_Stream5/Ch3
+ */
+static inline void ARGB_PrintConfig(const ARGB_PinConfig_t* cfg_p)
+{
+    const ARGB_PinConfig_t& cfg = *cfg_p;
     
     // GPIO Port name
     char port_name = '?';
@@ -459,7 +758,7 @@ static inline void ARGB_PrintPinConfig(uint32_t arduino_pin)
     Serial.print(F("_Stream"));
     Serial.print(stream_num);
     Serial.print(F("/Ch"));
-    Serial.println(dma_ch_num);
+    Serial.print(dma_ch_num);
 }
 
 #else
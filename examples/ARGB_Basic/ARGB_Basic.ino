@@ -58,10 +58,8 @@ void setup() {
 }
 
 void loop() {
-    // Rainbow effect
-    for (uint8_t i = 0; i < NUM_PIXELS; i++) {
-        ARGB_SetHSV(i, hue + i * (256 / NUM_PIXELS), 255, 255);
-    }
+    // Rainbow effect: вся лента одним вызовом, шаг оттенка на пиксель
+    ARGB_FillRainbow(0, NUM_PIXELS, hue, 256 / NUM_PIXELS, 255, 255);
     hue += 2;
     
     ARGB_Show();
@@ -0,0 +1,134 @@
+/**
+ * @file    ARGB_Benchmark.ino
+ * @brief   Замер горячих путей STM32-ARGB-DMA в тактах (DWT CYCCNT)
+ *
+ * Вывод в Serial - CSV, тот же формат что и у extras/bench (host):
+ *   bench,case,family,dma_size,variant,pixels,metric,value
+ * Для сравнения релизов собирайте с разными NUM_PIXELS / DMA_SIZE_* / семейством.
+ *
+ * Требуется ядро Cortex-M3 и выше (на M0 нет DWT CYCCNT).
+ */
+
+// ============================================================================
+// Конфигурация - ДО включения библиотеки!
+// ============================================================================
+#define NUM_PIXELS 60
+#define WS2812
+
+#include <ARGB.h>
+#include <ARGB_Auto.h>
+
+#define ARGB_PIN PA0
+#define BENCH_REPS 32  // Повторов на каждый замер
+
+#if defined(SK6812)
+#define BENCH_FAMILY "SK6812"
+#elif defined(WS2811S)
+#define BENCH_FAMILY "WS2811S"
+#elif defined(WS2811F)
+#define BENCH_FAMILY "WS2811F"
+#else
+#define BENCH_FAMILY "WS2812"
+#endif
+
+#if ARGB_PWM_WIDTH == 1
+#define BENCH_DMA_SIZE "BYTE"
+#elif ARGB_PWM_WIDTH == 2
+#define BENCH_DMA_SIZE "HWORD"
+#else
+#define BENCH_DMA_SIZE "WORD"
+#endif
+
+#if ARGB_USE_STREAMING
+#define BENCH_MODE "stream"
+#else
+#define BENCH_MODE "full"
+#endif
+#if ARGB_USE_LUT_ENCODER
+#define BENCH_VARIANT BENCH_MODE "-lut"
+#else
+#define BENCH_VARIANT BENCH_MODE "-bits"
+#endif
+
+extern "C" void DMA1_Stream5_IRQHandler(void) {
+    ARGB_DMA_IRQHandler();
+}
+
+// ============================================================================
+// Счётчик тактов
+// ============================================================================
+static void cycles_init(void) {
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+static inline uint32_t cycles_now(void) {
+    return DWT->CYCCNT;
+}
+
+static void bench_print(const char* name, uint32_t cycles, uint32_t reps) {
+    Serial.print(F("bench,"));
+    Serial.print(name);
+    Serial.print(F("," BENCH_FAMILY "," BENCH_DMA_SIZE "," BENCH_VARIANT ","));
+    Serial.print(NUM_PIXELS);
+    Serial.print(F(",cycles_per_pixel,"));
+    Serial.println((float)cycles / reps / NUM_PIXELS, 2);
+}
+
+// ============================================================================
+// Замеры
+// ============================================================================
+static void bench_show(void) {
+    uint32_t total = 0;
+    for (uint32_t r = 0; r < BENCH_REPS; r++) {
+        while (ARGB_Ready() != ARGB_READY) {}  // Ждём окончания прошлого кадра
+        uint32_t t0 = cycles_now();
+        ARGB_Show();  // Кодирование + запуск DMA (в streaming - только первые половины)
+        total += cycles_now() - t0;
+    }
+    bench_print("show_total", total, BENCH_REPS);
+}
+
+static void bench_fill_rgb(void) {
+    uint32_t t0 = cycles_now();
+    for (uint32_t r = 0; r < BENCH_REPS; r++)
+        ARGB_FillRGB(r, 0x55, 0xAA);
+    bench_print("fill_rgb", cycles_now() - t0, BENCH_REPS);
+}
+
+static void bench_set_hsv(void) {
+    uint32_t t0 = cycles_now();
+    for (uint32_t r = 0; r < BENCH_REPS; r++)
+        for (uint16_t i = 0; i < NUM_PIXELS; i++)
+            ARGB_SetHSV(i, r + i, 255, 255);
+    bench_print("set_hsv", cycles_now() - t0, BENCH_REPS);
+}
+
+static void bench_fill_rainbow(void) {
+    uint32_t t0 = cycles_now();
+    for (uint32_t r = 0; r < BENCH_REPS; r++)
+        ARGB_FillRainbow(0, NUM_PIXELS, r, 3, 255, 255);  // ARGB_USE_INT_HSV 0/1 - сравнение с float
+    bench_print("fill_rainbow", cycles_now() - t0, BENCH_REPS);
+}
+
+void setup() {
+    Serial.begin(115200);
+    delay(1000);
+
+    if (!ARGB_Begin(ARGB_PIN)) {
+        Serial.println(F("FATAL: ARGB init failed!"));
+        while (1) delay(100);
+    }
+    ARGB_SetBrightness(128);
+    cycles_init();
+
+    Serial.println(F("bench,case,family,dma_size,variant,pixels,metric,value"));
+    bench_fill_rgb();
+    bench_set_hsv();
+    bench_fill_rainbow();
+    bench_show();
+}
+
+void loop() {
+}
@@ -0,0 +1,79 @@
+/**
+ * @file    ARGB_Paced.ino
+ * @brief   Кадры с постоянной частотой от аппаратного таймера (ARGB_Pacer)
+ *
+ * Вместо ARGB_Show() + delay(20) кадр отправляется из прерывания таймера,
+ * а следующий рисуется сразу после - на период вперёд. Период не плывёт
+ * от времени отрисовки и длины ленты. Раз в секунду в Serial - статистика:
+ * джиттер, пропущенные кадры и запас времени (headroom) на кадр.
+ *
+ * Подключение: PA0 -> DATA ленты WS2812
+ */
+
+// ============================================================================
+// Конфигурация - ДО включения библиотеки!
+// ============================================================================
+#define NUM_PIXELS 60
+#define WS2812
+
+#include <ARGB.h>
+#include <ARGB_Auto.h>
+
+#define ARGB_PIN PA0
+#define FPS 50
+#define PACE_TIM TIM10  // Любой свободный таймер, не тот что у ленты
+
+extern "C" void DMA1_Stream5_IRQHandler(void) {
+    ARGB_DMA_IRQHandler();
+}
+
+static ARGB_Pacer pacer;
+static uint8_t hue = 0;
+
+// Вызывается из прерывания таймера - только отрисовка, без Serial и delay
+static void render(ARGB_Strip* strip, void* ctx) {
+    (void)ctx;
+    ARGB_FillRainbow_Ex(strip, 0, NUM_PIXELS, hue, 256 / NUM_PIXELS, 255, 255);
+    hue += 2;
+}
+
+static uint32_t clock_us(void) {
+    return micros();
+}
+
+static void on_tick(void) {
+    ARGB_PacerTick(&pacer);
+}
+
+void setup() {
+    Serial.begin(115200);
+    delay(1000);
+
+    if (!ARGB_Begin(ARGB_PIN)) {
+        Serial.println(F("FATAL: ARGB init failed!"));
+        while (1) delay(100);
+    }
+    ARGB_SetBrightness(25);
+
+    ARGB_PacerInit(&pacer, &ARGB_DefaultStrip, FPS, render, NULL, clock_us);
+    render(&ARGB_DefaultStrip, NULL);  // Первый кадр уйдёт на первом тике
+
+    HardwareTimer* tim = new HardwareTimer(PACE_TIM);
+    tim->setOverflow(FPS, HERTZ_FORMAT);
+    tim->attachInterrupt(on_tick);
+    tim->resume();
+}
+
+void loop() {
+    ARGB_PacerStats st;
+    ARGB_PacerGetStats(&pacer, &st);
+    Serial.print(F("frames="));     Serial.print(st.frames);
+    Serial.print(F(" missed="));    Serial.print(st.missed);
+    Serial.print(F(" jitter_avg=")); Serial.print(st.jitter_avg_us);
+    Serial.print(F("us max="));     Serial.print(st.jitter_max_us);
+    Serial.print(F("us work="));    Serial.print(st.work_max_us);
+    Serial.print(F("us wire="));    Serial.print(st.wire_us);
+    Serial.print(F("us headroom=")); Serial.print(st.headroom_us);
+    Serial.println(F("us"));
+    delay(1000);
+}
@@ -0,0 +1,275 @@
+/**
+ *******************************************
+ * @file    ARGB_Bench.c
+ * @brief   Host benchmark of ARGB Driver hot paths (simulation backend)
+ *******************************************
+ *
+ * @note ARGB.c is included directly so private helpers (HSV2RGB_*) can be
+ *       measured too. One binary = one configuration (NUM_PIXELS, family,
+ *       DMA_SIZE_*), run.sh builds and runs the whole matrix.
+ *
+ * @note Output is CSV, one line per measurement:
+ *       bench,case,family,dma_size,variant,pixels,metric,value
+ */
+
+#include <time.h>
+#include "../../src/ARGB.c"
+
+#if defined(SK6812)
+#define BENCH_FAMILY "SK6812"
+#elif defined(WS2811S)
+#define BENCH_FAMILY "WS2811S"
+#elif defined(WS2811F)
+#define BENCH_FAMILY "WS2811F"
+#else
+#define BENCH_FAMILY "WS2812"
+#endif
+
+#if ARGB_PWM_WIDTH == 1
+#define BENCH_DMA_SIZE "BYTE"
+#define BENCH_MALIGN DMA_MDATAALIGN_BYTE
+#elif ARGB_PWM_WIDTH == 2
+#define BENCH_DMA_SIZE "HWORD"
+#define BENCH_MALIGN DMA_MDATAALIGN_HALFWORD
+#else
+#define BENCH_DMA_SIZE "WORD"
+#define BENCH_MALIGN DMA_MDATAALIGN_WORD
+#endif
+
+#if ARGB_USE_STREAMING
+#define BENCH_MODE "stream"
+#else
+#define BENCH_MODE "full"
+#endif
+#if ARGB_USE_DITHER
+#define BENCH_DITHER "-dither"
+#else
+#define BENCH_DITHER ""
+#endif
+#if ARGB_USE_LUT_ENCODER
+#define BENCH_VARIANT BENCH_MODE "-lut" BENCH_DITHER
+#else
+#define BENCH_VARIANT BENCH_MODE "-bits" BENCH_DITHER
+#endif
+
+#ifndef BENCH_MIN_NS
+#define BENCH_MIN_NS 20000000ULL ///< Minimum run time per sample (20 ms)
+#endif
+#define BENCH_SAMPLES 5          ///< Best of N samples is reported
+
+extern DMA_HandleTypeDef hdma_tim2_ch2_ch4;
+
+static volatile u8_t bench_sink; ///< Keeps HSV2RGB results alive
+static u8_t bench_frame[NUM_PIXELS * 3]; ///< Packed RGB frame for write_pixels
+
+#define BENCH_PAR_LANES 16
+ARGB_PAR_DEF(bench_par, BENCH_PAR_LANES, NUM_PIXELS); ///< Parallel output, one DMA for all lanes
+static TIM_HandleTypeDef bench_par_htim;
+static DMA_HandleTypeDef bench_par_hdma;
+
+ARGB_BURST_DEF(bench_burst, ARGB_BURST_MAX_CH, NUM_PIXELS); ///< CCR1..CCR4 via DMAR burst
+static TIM_HandleTypeDef bench_burst_htim;
+static DMA_HandleTypeDef bench_burst_hdma;
+
+typedef void (*bench_fn)(u32_t iter);
+
+static unsigned long long bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/// Best-of-N ns per call, every sample runs at least BENCH_MIN_NS
+static double bench_run(bench_fn fn) {
+    double best = 0;
+    for (int s = 0; s < BENCH_SAMPLES; s++) {
+        u32_t calls = 0;
+        unsigned long long t0 = bench_now(), t1;
+        do {
+            fn(calls++);
+            t1 = bench_now();
+        } while (t1 - t0 < BENCH_MIN_NS);
+        double per = (double) (t1 - t0) / calls;
+        if (s == 0 || per < best) best = per;
+    }
+    return best;
+}
+
+static void bench_print(const char *name, double ns_per_pixel) {
+    printf("bench,%s,%s,%s,%s,%u,ns_per_pixel,%.3f\n", name, BENCH_FAMILY,
+           BENCH_DMA_SIZE, BENCH_VARIANT, (unsigned) NUM_PIXELS, ns_per_pixel);
+}
+
+// ---- Cases ----
+
+static void case_show(u32_t iter) {
+    (void) iter;
+    ARGB_MarkDirty(&ARGB_DefaultStrip, 0, NUM_BYTES); // Whole frame changed, no dither level reload
+    ARGB_Show();
+    // Sim transfer is a plain copy loop, it is part of show_total only
+    ARGB_Sim_RunDMA(&hdma_tim2_ch2_ch4);
+    ARGB_Sim_ClearCapture(&hdma_tim2_ch2_ch4);
+}
+
+/// Finish the frame started by ARGB_Show()
+static void bench_complete(void) {
+#if ARGB_USE_STREAMING
+    ARGB_Sim_RunDMA(&hdma_tim2_ch2_ch4); // Refills are part of the frame
+    ARGB_Sim_ClearCapture(&hdma_tim2_ch2_ch4);
+#else
+    // Complete the transfer without the sim copy loop: driver CPU time only
+    if (hdma_tim2_ch2_ch4.State != HAL_DMA_STATE_BUSY) return; // frame skipped
+    hdma_tim2_ch2_ch4.State = HAL_DMA_STATE_READY;
+    hdma_tim2_ch2_ch4.XferCpltCallback(&hdma_tim2_ch2_ch4);
+#endif
+}
+
+static void case_show_1px(u32_t iter) {
+    ARGB_SetRGB(iter % NUM_PIXELS, (u8_t) iter, 0x55, 0xAA); // Only the dirty pixel is re-encoded
+    ARGB_Show();
+    bench_complete();
+}
+
+#if ARGB_USE_DITHER
+static void case_show_dither(u32_t iter) {
+    (void) iter;
+    ARGB_Show(); // Static dim frame: dither step + re-encode of the bytes that flipped
+    bench_complete();
+}
+#endif
+
+#if ARGB_SKIP_UNCHANGED
+static void case_show_static(u32_t iter) {
+    (void) iter;
+    ARGB_Show(); // Unchanged frame, skipped
+}
+#endif
+
+static void case_encode(u32_t iter) {
+    (void) iter;
+#if ARGB_USE_STREAMING
+    // Same work the HT/TC callbacks do over a whole frame
+    ARGB_Strip *strip = &ARGB_DefaultStrip;
+    strip->stream_byte = 0;
+    strip->stream_src = strip->rgb_buf;
+    strip->stream_end = NUM_BYTES;
+    for (u16_t h = 0; h < ARGB_StreamHalves(strip); h++)
+        ARGB_StreamFill(strip, (h & 1) * PWM_HALF_LEN);
+#else
+    ARGB_DefaultStrip.encode(&ARGB_DefaultStrip, PWM_BUF, RGB_BUF, NUM_BYTES);
+#endif
+}
+
+static void case_par_encode(u32_t iter) {
+    (void) iter;
+    ARGB_ParEncode(&bench_par);
+}
+
+static void case_burst_encode(u32_t iter) {
+    (void) iter;
+    ARGB_BurstEncode(&bench_burst);
+}
+
+static void case_fill_rgb(u32_t iter) {
+    ARGB_FillRGB((u8_t) iter, 0x55, 0xAA);
+}
+
+static void case_set_rgb(u32_t iter) {
+    for (u16_t i = 0; i < NUM_PIXELS; i++)
+        ARGB_SetRGB(i, (u8_t) (iter + i), (u8_t) i, 0xAA);
+}
+
+static void case_write_pixels(u32_t iter) {
+    (void) iter;
+    ARGB_WritePixels(0, bench_frame, NUM_PIXELS);
+}
+
+static void case_set_hsv(u32_t iter) {
+    for (u16_t i = 0; i < NUM_PIXELS; i++)
+        ARGB_SetHSV(i, (u8_t) (iter + i), 255, 255);
+}
+
+static void case_hsv2rgb(u32_t iter) {
+    u8_t r, g, b;
+    for (u16_t i = 0; i < NUM_PIXELS; i++) {
+        HSV2RGB((u8_t) (iter + i), 255, 255, &r, &g, &b);
+        bench_sink ^= r ^ g ^ b;
+    }
+}
+
+static void case_hsv2rgb_int(u32_t iter) {
+    u8_t r, g, b;
+    for (u16_t i = 0; i < NUM_PIXELS; i++) {
+        HSV2RGB_Int((u8_t) (iter + i), 200, 255, &r, &g, &b);
+        bench_sink ^= r ^ g ^ b;
+    }
+}
+
+static void case_hsv2rgb_float(u32_t iter) {
+    u8_t r, g, b;
+    for (u16_t i = 0; i < NUM_PIXELS; i++) {
+        HSV2RGB_Float((u8_t) (iter + i), 200, 255, &r, &g, &b);
+        bench_sink ^= r ^ g ^ b;
+    }
+}
+
+static void case_fill_rainbow(u32_t iter) {
+    ARGB_FillRainbow(0, NUM_PIXELS, (u8_t) iter, 3, 255, 255);
+}
+
+int main(void) {
+    ARGB_Sim_Reset();
+    hdma_tim2_ch2_ch4.Init.MemDataAlignment = BENCH_MALIGN;
+#if ARGB_USE_STREAMING
+    hdma_tim2_ch2_ch4.Init.Mode = DMA_CIRCULAR;
+#endif
+    ARGB_Init();
+    ARGB_SetBrightness(128);
+    for (u16_t i = 0; i < NUM_PIXELS; i++)
+        ARGB_SetRGB(i, (u8_t) (i * 37), (u8_t) (i * 11), (u8_t) (i * 5));
+    for (u32_t i = 0; i < sizeof(bench_frame); i++)
+        bench_frame[i] = (u8_t) (i * 29);
+
+    bench_par_htim.Instance = TIM1;
+    bench_par_hdma.Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+    HAL_DMA_Init(&bench_par_hdma);
+    ARGB_ParAttach(&bench_par, &bench_par_htim, &bench_par_hdma, GPIOB, 0, 2 * ARGB_SIM_PCLK2);
+    ARGB_ParInit(&bench_par);
+    for (u8_t l = 0; l < BENCH_PAR_LANES; l++)
+        for (u16_t i = 0; i < NUM_PIXELS; i++)
+            ARGB_ParSetRGB(&bench_par, l, i, (u8_t) (i * 37 + l), (u8_t) (i * 11), (u8_t) (l * 5));
+    bench_burst_htim.Instance = TIM4;
+    bench_burst_hdma.Init.MemDataAlignment = BENCH_MALIGN;
+    HAL_DMA_Init(&bench_burst_hdma);
+    ARGB_BurstAttach(&bench_burst, &bench_burst_htim, &bench_burst_hdma, 2 * ARGB_SIM_PCLK1);
+    ARGB_BurstInit(&bench_burst);
+    for (u8_t c = 0; c < ARGB_BURST_MAX_CH; c++)
+        for (u16_t i = 0; i < NUM_PIXELS; i++)
+            ARGB_BurstSetRGB(&bench_burst, c, i, (u8_t) (i * 37 + c), (u8_t) (i * 11), (u8_t) (c * 5));
+
+    bench_print("show_encode", bench_run(case_encode) / NUM_PIXELS);
+    // Per LED over all lanes, comparable with show_encode
+    bench_print("par_encode", bench_run(case_par_encode) / NUM_PIXELS / BENCH_PAR_LANES);
+    bench_print("burst_encode", bench_run(case_burst_encode) / NUM_PIXELS / ARGB_BURST_MAX_CH);
+    bench_print("show_total", bench_run(case_show) / NUM_PIXELS);
+    bench_print("show_1px", bench_run(case_show_1px) / NUM_PIXELS);
+#if ARGB_SKIP_UNCHANGED
+    bench_print("show_static", bench_run(case_show_static) / NUM_PIXELS);
+#endif
+    bench_print("fill_rgb", bench_run(case_fill_rgb) / NUM_PIXELS);
+    bench_print("set_rgb", bench_run(case_set_rgb) / NUM_PIXELS);
+    bench_print("write_pixels", bench_run(case_write_pixels) / NUM_PIXELS);
+    bench_print("set_hsv", bench_run(case_set_hsv) / NUM_PIXELS);
+    bench_print("hsv2rgb", bench_run(case_hsv2rgb) / NUM_PIXELS);
+    bench_print("hsv2rgb_int", bench_run(case_hsv2rgb_int) / NUM_PIXELS);
+    bench_print("hsv2rgb_float", bench_run(case_hsv2rgb_float) / NUM_PIXELS);
+    bench_print("fill_rainbow", bench_run(case_fill_rainbow) / NUM_PIXELS);
+#if ARGB_USE_DITHER
+    // Night brightness, every byte has a fraction to diffuse
+    ARGB_SetBrightness(10);
+    for (u16_t i = 0; i < NUM_PIXELS; i++)
+        ARGB_SetRGB(i, (u8_t) (i * 37), (u8_t) (i * 11), (u8_t) (i * 5));
+    bench_print("show_dither", bench_run(case_show_dither) / NUM_PIXELS);
+#endif
+    return 0;
+}
@@ -0,0 +1,33 @@
+#!/bin/sh
+# Build and run ARGB_Bench.c for every configuration of the matrix.
+# Usage: extras/bench/run.sh [pixels...] > bench_output.txt
+# Env:   CC (default cc), CFLAGS (default -O2), EXTRA (extra -D options)
+set -e
+
+ROOT=$(cd "$(dirname "$0")/../.." && pwd)
+CC=${CC:-cc}
+CFLAGS=${CFLAGS:-"-O2"}
+PIXELS=${*:-"8 60 300 1200"}
+OUT=$(mktemp -d)
+trap 'rm -rf "$OUT"' EXIT
+
+echo "bench,case,family,dma_size,variant,pixels,metric,value"
+for family in WS2812 SK6812; do
+    for dma in DMA_SIZE_BYTE DMA_SIZE_HWORD DMA_SIZE_WORD; do
+        for stream in 0 1; do
+            for lut in 0 1; do
+                for dither in 0 1; do
+                    for n in $PIXELS; do
+                        bin="$OUT/bench_${family}_${dma}_${stream}_${lut}_${dither}_${n}"
+                        $CC $CFLAGS -D$family -D$dma -DNUM_PIXELS=$n \
+                            -DARGB_USE_STREAMING=$stream -DARGB_USE_LUT_ENCODER=$lut \
+                            -DARGB_USE_DITHER=$dither -DARGB_SKIP_UNCHANGED=1 $EXTRA \
+                            -I"$ROOT/extras/sim" -I"$ROOT/src" \
+                            "$ROOT/extras/bench/ARGB_Bench.c" "$ROOT/extras/sim/ARGB_Sim.c" -o "$bin" -lm
+                        "$bin"
+                    done
+                done
+            done
+        done
+    done
+done
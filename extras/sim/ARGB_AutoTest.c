@@ -0,0 +1,222 @@
+/**
+ *******************************************
+ * @file    ARGB_AutoTest.c
+ * @brief   Host build of ARGB_Auto.h: pin analysis and the DMA stream allocator
+ *******************************************
+ *
+ * @note Pins resolve through the stand-in PinMap_PWM (PeripheralPins.h) and
+ *       the F4 ARGB_DMA_MAP. Allocations are checked against the request
+ *       table, then strips are set up from them with ARGB_SetupConfig_Ex(),
+ *       sent together and their frames decoded from the simulated DMA.
+ * @note Usage: auto_test, exit code 0 if every check passed
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "main.h"
+#include "ARGB.h"
+#include "ARGB_Auto.h"
+
+#if USE_GAMMA_CORRECTION
+#error Frames are compared with the raw colours, build without USE_GAMMA_CORRECTION
+#endif
+
+#define TEST_BYTES (NUM_PIXELS * ARGB_BYTES_PER_PIXEL) ///< Wire bytes of one strip
+#define TEST_STRIPS 3   ///< Strips set up from one allocation
+
+ARGB_STRIP_DEF(shelf, NUM_PIXELS);
+ARGB_STRIP_DEF(desk, NUM_PIXELS);
+ARGB_STRIP_DEF(door, NUM_PIXELS);
+
+static ARGB_Strip *const strips[TEST_STRIPS] = {&shelf, &desk, &door};
+static ARGB_AutoHW_t hw[TEST_STRIPS];
+static unsigned failures;
+
+#define CHECK(cond) test_check((cond), #cond, __LINE__)
+
+static void test_check(int ok, const char *what, int line) {
+    if (ok) return;
+    printf("FAIL %s:%d: %s\n", __FILE__, line, what);
+    failures++;
+}
+
+/// No two strips of an allocation that came back OK share a timer or a stream
+static int test_disjoint(const ARGB_PinConfig_t *cfg, const ARGB_DMA_Result_t *res, uint8_t n) {
+    for (uint8_t i = 0; i < n; i++)
+        for (uint8_t j = 0; j < i; j++) {
+            if (res[i] != ARGB_DMA_OK || res[j] != ARGB_DMA_OK) continue;
+            if (cfg[i].tim == cfg[j].tim || cfg[i].dma_stream == cfg[j].dma_stream) return 0;
+        }
+    return 1;
+}
+
+#if ARGB_USE_HW_LATCH
+static void shelf_tim_irq(void) { ARGB_TIM_IRQHandler_Ex(&shelf); }
+static void desk_tim_irq(void) { ARGB_TIM_IRQHandler_Ex(&desk); }
+static void door_tim_irq(void) { ARGB_TIM_IRQHandler_Ex(&door); }
+static void (*const tim_irq[TEST_STRIPS])(void) = {shelf_tim_irq, desk_tim_irq, door_tim_irq};
+#endif
+
+// ---- Tests ----
+
+/// First PWM entry and first stream of the pin, as before the allocator
+static void test_analyze(void) {
+    ARGB_PinConfig_t cfg;
+    printf("test analyze\n");
+    CHECK(ARGB_AnalyzePin(PA0, &cfg) == ARGB_DMA_OK);
+    CHECK(cfg.gpio_port == GPIOA && cfg.gpio_pin == 1U);
+    CHECK(cfg.tim == TIM2 && cfg.tim_channel == TIM_CHANNEL_1 && cfg.tim_af == 1);
+    CHECK(cfg.tim_dma_cc == TIM_DMA_CC1 && cfg.is_32bit_tim == 1);
+    CHECK(cfg.dma_stream == DMA1_Stream5 && cfg.dma_channel == DMA_CHANNEL_3);
+    CHECK(cfg.dma_irqn == DMA1_Stream5_IRQn);
+    CHECK(ARGB_PwmWidth(&cfg) == ARGB_PWM_WIDTH); // Channel DMA core in the simulation
+
+    CHECK(ARGB_AnalyzePin(PA8, &cfg) == ARGB_DMA_OK);
+    CHECK(cfg.tim == TIM1 && cfg.is_32bit_tim == 0 && cfg.dma_stream == DMA2_Stream1);
+    CHECK(ARGB_AnalyzePin(PC13, &cfg) == ARGB_DMA_NO_PWM);
+    CHECK(ARGB_AnalyzePin(PB9, &cfg) == ARGB_DMA_NO_DMA); // TIM4_CH4
+    CHECK(ARGB_AnalyzePin(0x30, &cfg) == ARGB_DMA_ERR);   // No such pin
+    CHECK(ARGB_AnalyzePin(PA0, NULL) == ARGB_DMA_ERR);
+}
+
+/// A strip that collides with nobody keeps the mapping of ARGB_AnalyzePin()
+static void test_alloc_single(void) {
+    static const uint32_t pins[] = {PA0, PA8, PB4, PB8};
+    ARGB_PinConfig_t cfg, want;
+    ARGB_DMA_Result_t res;
+    printf("test alloc_single\n");
+    for (uint8_t i = 0; i < sizeof(pins) / sizeof(pins[0]); i++) {
+        CHECK(ARGB_AllocateDMA(&pins[i], 1, 0, &cfg, &res) == 1);
+        CHECK(res == ARGB_DMA_OK);
+        CHECK(ARGB_AnalyzePin(pins[i], &want) == ARGB_DMA_OK);
+        CHECK(memcmp(&cfg, &want, sizeof(cfg)) == 0);
+    }
+}
+
+/// TIM2_CH1 and TIM3_CH2 both default to DMA1_Stream5: PA0 moves to TIM5
+static void test_alloc_move(void) {
+    static const uint32_t pins[TEST_STRIPS] = {PA0, PB5, PB8};
+    ARGB_PinConfig_t cfg[TEST_STRIPS];
+    ARGB_DMA_Result_t res[TEST_STRIPS];
+    printf("test alloc_move\n");
+    CHECK(ARGB_AllocateDMA(pins, TEST_STRIPS, 0, cfg, res) == TEST_STRIPS);
+    CHECK(res[0] == ARGB_DMA_OK && res[1] == ARGB_DMA_OK && res[2] == ARGB_DMA_OK);
+    CHECK(cfg[0].tim == TIM5 && cfg[0].tim_af == 2 && cfg[0].dma_stream == DMA1_Stream2);
+    CHECK(cfg[0].dma_channel == DMA_CHANNEL_6 && cfg[0].dma_irqn == DMA1_Stream2_IRQn);
+    CHECK(cfg[0].gpio_port == GPIOA && cfg[0].gpio_pin == 1U); // Same pin, other timer
+    CHECK(cfg[1].tim == TIM3 && cfg[1].dma_stream == DMA1_Stream5);
+    CHECK(cfg[2].tim == TIM4 && cfg[2].dma_stream == DMA1_Stream7);
+    CHECK(test_disjoint(cfg, res, TEST_STRIPS));
+}
+
+/// Fewest moves wins: PA1 to TIM5 (1) beats PA3 to TIM5_CH4 (2)
+static void test_alloc_cost(void) {
+    static const uint32_t pins[3] = {PA1, PA3, PB8};
+    ARGB_PinConfig_t cfg[3];
+    ARGB_DMA_Result_t res[3];
+    printf("test alloc_cost\n");
+    CHECK(ARGB_AllocateDMA(pins, 3, 0, cfg, res) == 3);
+    CHECK(cfg[0].tim == TIM5 && cfg[0].tim_channel == TIM_CHANNEL_2 && cfg[0].dma_stream == DMA1_Stream4);
+    CHECK(cfg[1].tim == TIM2 && cfg[1].tim_channel == TIM_CHANNEL_4 && cfg[1].dma_stream == DMA1_Stream6);
+    CHECK(cfg[2].tim == TIM4 && cfg[2].dma_stream == DMA1_Stream7);
+    CHECK(test_disjoint(cfg, res, 3));
+}
+
+/// Complementary outputs are skipped, _ALT1 timers are not
+static void test_alloc_alt(void) {
+    const uint32_t pin = PA7;
+    ARGB_PinConfig_t cfg;
+    ARGB_DMA_Result_t res;
+    printf("test alloc_alt\n");
+    CHECK(ARGB_AllocateDMA(&pin, 1, 0, &cfg, &res) == 1);
+    CHECK(res == ARGB_DMA_OK);
+    CHECK(cfg.tim == TIM3 && cfg.tim_channel == TIM_CHANNEL_2 && cfg.dma_stream == DMA1_Stream5);
+}
+
+/// Two channels of one timer cannot run together: the later strip gets its default
+static void test_alloc_conflict(void) {
+    static const uint32_t pins[3] = {PB4, PB5, PA0};
+    ARGB_PinConfig_t cfg[3], want;
+    ARGB_DMA_Result_t res[3];
+    printf("test alloc_conflict\n");
+    CHECK(ARGB_AllocateDMA(pins, 3, 0, cfg, res) == 2);
+    CHECK(res[0] == ARGB_DMA_OK && res[1] == ARGB_DMA_CONFLICT && res[2] == ARGB_DMA_OK);
+    CHECK(ARGB_AnalyzePin(PB5, &want) == ARGB_DMA_OK);
+    CHECK(memcmp(&cfg[1], &want, sizeof(want)) == 0);
+    CHECK(cfg[2].tim == TIM2 && cfg[2].dma_stream == DMA1_Stream5); // Stream5 is free again
+    CHECK(test_disjoint(cfg, res, 3));
+
+    static const uint32_t tim1[2] = {PA8, PA9}; // TIM1_CH1 / TIM1_CH2, DMA2 only
+    CHECK(ARGB_AllocateDMA(tim1, 2, 3, cfg, res) == 1);
+    CHECK(res[0] == ARGB_DMA_OK && res[1] == ARGB_DMA_CONFLICT);
+    CHECK(cfg[0].dma_stream == DMA2_Stream1 && cfg[1].dma_stream == DMA2_Stream2);
+}
+
+/// Pins without a timer or a stream are reported, not placed
+static void test_alloc_errors(void) {
+    static const uint32_t pins[ARGB_ALLOC_MAX_PINS + 1] = {PC13, PB9, PA8, PB4, PB6, PA0, PA1, PA2, PA3};
+    ARGB_PinConfig_t cfg[ARGB_ALLOC_MAX_PINS + 1];
+    ARGB_DMA_Result_t res[ARGB_ALLOC_MAX_PINS + 1];
+    printf("test alloc_errors\n");
+    memset(cfg, 0xA5, sizeof(cfg));
+    res[ARGB_ALLOC_MAX_PINS] = ARGB_DMA_ERR;
+    const uint8_t count = ARGB_AllocateDMA(pins, ARGB_ALLOC_MAX_PINS + 1, 0, cfg, res);
+    CHECK(res[0] == ARGB_DMA_NO_PWM && res[1] == ARGB_DMA_NO_DMA);
+    CHECK(cfg[0].tim == NULL && cfg[1].tim == NULL && cfg[1].dma_stream == NULL);
+    CHECK(res[ARGB_ALLOC_MAX_PINS] == ARGB_DMA_ERR); // Past the limit: untouched
+    CHECK(count == 5); // TIM1, TIM3, TIM4 + TIM2 and TIM5 for the four TIM2/TIM5 pins
+    CHECK(test_disjoint(cfg, res, ARGB_ALLOC_MAX_PINS));
+    CHECK(ARGB_SetupConfig_Ex(&shelf, &hw[0], &cfg[0]) == ARGB_DMA_ERR);
+}
+
+/// Strips set up from one allocation send at the same time
+static void test_setup(void) {
+    static const uint32_t pins[TEST_STRIPS] = {PA0, PB5, PB8};
+    ARGB_PinConfig_t cfg[TEST_STRIPS];
+    ARGB_DMA_Result_t res[TEST_STRIPS];
+    u8_t exp[TEST_STRIPS][TEST_BYTES], out[TEST_BYTES];
+    printf("test setup\n");
+    CHECK(ARGB_AllocateDMA(pins, TEST_STRIPS, 0, cfg, res) == TEST_STRIPS);
+    memset(exp, 0, sizeof(exp));
+    for (uint8_t s = 0; s < TEST_STRIPS; s++) {
+        CHECK(ARGB_SetupConfig_Ex(strips[s], &hw[s], &cfg[s]) == ARGB_DMA_OK);
+        CHECK(hw[s].htim.Instance == cfg[s].tim);
+        CHECK(hw[s].hdma.Instance == cfg[s].dma_stream);
+        CHECK(hw[s].hdma.Init.Channel == cfg[s].dma_channel);
+        CHECK(hw[s].htim.hdma[TIM_DMA_ID_CC1 + (cfg[s].tim_channel >> 2)] == &hw[s].hdma);
+        CHECK(cfg[s].tim->ARR == 2 * ARGB_SIM_PCLK1 / ARGB_LED_DEFAULT.bit_hz - 1); // APB1 timers
+#if ARGB_USE_HW_LATCH
+        ARGB_Sim_SetTimIRQ(cfg[s].tim, tim_irq[s]);
+#endif
+        for (u16_t i = 0; i < NUM_PIXELS; i++) {
+            const u8_t r = (u8_t) (i * 31 + s), g = (u8_t) (s * 70 + 1), b = (u8_t) (i * 7);
+            ARGB_SetRGB_Ex(strips[s], i, r, g, b);
+            exp[s][i * ARGB_BYTES_PER_PIXEL + ARGB_LED_DEFAULT.order[0]] = r;
+            exp[s][i * ARGB_BYTES_PER_PIXEL + ARGB_LED_DEFAULT.order[1]] = g;
+            exp[s][i * ARGB_BYTES_PER_PIXEL + ARGB_LED_DEFAULT.order[2]] = b;
+        }
+    }
+    for (uint8_t s = 0; s < TEST_STRIPS; s++) CHECK(ARGB_Show_Ex(strips[s]) == ARGB_OK);
+    for (uint8_t s = 0; s < TEST_STRIPS; s++) CHECK(ARGB_Ready_Ex(strips[s]) == ARGB_BUSY);
+    ARGB_Sim_RunAll();
+    for (uint8_t s = 0; s < TEST_STRIPS; s++) {
+        CHECK(ARGB_Ready_Ex(strips[s]) == ARGB_READY);
+        CHECK(ARGB_Sim_Decode(&hw[s].hdma, strips[s]->pwm_lo, strips[s]->pwm_hi, out, TEST_BYTES) == TEST_BYTES);
+        CHECK(memcmp(out, exp[s], TEST_BYTES) == 0);
+    }
+}
+
+int main(void) {
+    ARGB_Sim_Reset();
+    test_analyze();
+    test_alloc_single();
+    test_alloc_move();
+    test_alloc_cost();
+    test_alloc_alt();
+    test_alloc_conflict();
+    test_alloc_errors();
+    test_setup();
+
+    printf("%s: %u failed\n", failures ? "FAIL" : "ok", failures);
+    return failures ? 1 : 0;
+}
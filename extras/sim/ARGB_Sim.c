@@ -0,0 +1,286 @@
+/**
+ *******************************************
+ * @file    ARGB_Sim.c
+ * @brief   Host simulation backend for ARGB Driver
+ *******************************************
+ */
+
+#include "main.h"
+#include "ARGB.h"  // ARGB_PWM_WIDTH: default DMA width of the legacy handle
+#include <stdlib.h>
+#include <string.h>
+
+/// One tracked DMA stream
+typedef struct {
+    DMA_HandleTypeDef *hdma; ///< Owner handle
+    uintptr_t src;           ///< Memory address
+    uintptr_t dst;           ///< Peripheral register
+    uint32_t len;            ///< Elements per transfer
+    uint32_t starts;         ///< HAL_DMA_Start_IT() calls
+    uint32_t *cap;           ///< Captured values
+    uint32_t cap_len;        ///< Captured count
+    uint32_t cap_size;       ///< Allocated count
+} ARGB_SimStream;
+
+RCC_TypeDef ARGB_Sim_RCC;
+uint32_t ARGB_Sim_PRIMASK;
+uint32_t ARGB_Sim_Tick;
+DWT_Type ARGB_Sim_DWT;
+CoreDebug_Type ARGB_Sim_CoreDebug;
+TIM_TypeDef ARGB_Sim_TIM[9];
+GPIO_TypeDef ARGB_Sim_GPIO[3];
+
+/// Legacy CubeMX handles expected by ARGB.c defaults (TIM2 CH2)
+TIM_HandleTypeDef htim2;
+DMA_HandleTypeDef hdma_tim2_ch2_ch4;
+
+static ARGB_SimStream s_streams[ARGB_SIM_MAX_DMA];
+static void (*s_tim_irq[9])(void); ///< Timer IRQ handlers, index = timer number
+
+static ARGB_SimStream *ARGB_Sim_Find(const DMA_HandleTypeDef *hdma, int create) {
+    for (int i = 0; i < ARGB_SIM_MAX_DMA; i++)
+        if (s_streams[i].hdma == hdma) return &s_streams[i];
+    if (!create) return NULL;
+    for (int i = 0; i < ARGB_SIM_MAX_DMA; i++) {
+        if (s_streams[i].hdma == NULL) {
+            s_streams[i].hdma = (DMA_HandleTypeDef *) hdma;
+            return &s_streams[i];
+        }
+    }
+    return NULL;
+}
+
+static void ARGB_Sim_Push(ARGB_SimStream *st, uint32_t val) {
+    if (st->cap_len == st->cap_size) {
+        st->cap_size = st->cap_size ? st->cap_size * 2 : 1024;
+        st->cap = (uint32_t *) realloc(st->cap, st->cap_size * sizeof(uint32_t));
+    }
+    st->cap[st->cap_len++] = val;
+}
+
+static uint32_t ARGB_Sim_Width(uint32_t align, uint32_t half, uint32_t word) {
+    return align == word ? 4 : align == half ? 2 : 1;
+}
+
+void *ARGB_Sim_Ptr(uint32_t addr) {
+    static const uint8_t anchor = 0;
+    uintptr_t base = (uintptr_t) &anchor;
+    if (sizeof(uintptr_t) > 4) base &= ~(uintptr_t) 0xFFFFFFFFu;
+    else base = 0;
+    return (void *) (base | addr);
+}
+
+void ARGB_Sim_Reset(void) {
+    for (int i = 0; i < ARGB_SIM_MAX_DMA; i++) free(s_streams[i].cap);
+    memset(s_streams, 0, sizeof(s_streams));
+    memset(ARGB_Sim_TIM, 0, sizeof(ARGB_Sim_TIM));
+    memset(s_tim_irq, 0, sizeof(s_tim_irq));
+    memset(ARGB_Sim_GPIO, 0, sizeof(ARGB_Sim_GPIO));
+    ARGB_Sim_PRIMASK = 0;
+    ARGB_Sim_Tick = 0;
+    memset(&ARGB_Sim_DWT, 0, sizeof(ARGB_Sim_DWT));
+    ARGB_Sim_CoreDebug.DEMCR = 0;
+    ARGB_Sim_RCC.CFGR = (4UL << 10) | (4UL << 13); // APB1/APB2 prescalers active
+
+    memset(&htim2, 0, sizeof(htim2));
+    memset(&hdma_tim2_ch2_ch4, 0, sizeof(hdma_tim2_ch2_ch4));
+    htim2.Instance = TIM2;
+    hdma_tim2_ch2_ch4.Init.PeriphDataAlignment = DMA_PDATAALIGN_WORD;
+    hdma_tim2_ch2_ch4.Init.MemDataAlignment = ARGB_PWM_WIDTH == 4 ? DMA_MDATAALIGN_WORD :
+                                              ARGB_PWM_WIDTH == 2 ? DMA_MDATAALIGN_HALFWORD : DMA_MDATAALIGN_BYTE;
+    HAL_DMA_Init(&hdma_tim2_ch2_ch4);
+    __HAL_LINKDMA(&htim2, hdma[TIM_DMA_ID_CC2], hdma_tim2_ch2_ch4);
+}
+
+/// Core cycles in one period of timer k
+static uint32_t ARGB_Sim_PeriodCycles(int k) {
+    const uint64_t tclk = (k == 1 || k == 8) ? 2ULL * ARGB_SIM_PCLK2 : 2ULL * ARGB_SIM_PCLK1;
+    const uint64_t ticks = (uint64_t) (ARGB_Sim_TIM[k].PSC + 1) * (ARGB_Sim_TIM[k].ARR + 1);
+    return (uint32_t) (ticks * ARGB_SIM_SYSCLK / tclk);
+}
+
+/// Core cycles per element: one period of the timer owning the destination
+/// register (CCR, DMAR), or of the running timer with update DMA (GPIO BSRR)
+static uint32_t ARGB_Sim_ElementCycles(const ARGB_SimStream *st) {
+    int k = 0;
+    for (int i = 1; i < 9 && !k; i++) {
+        const uintptr_t tim = (uintptr_t) &ARGB_Sim_TIM[i];
+        if (st->dst >= tim && st->dst < tim + sizeof(TIM_TypeDef)) k = i;
+    }
+    for (int i = 1; i < 9 && !k; i++)
+        if ((ARGB_Sim_TIM[i].CR1 & TIM_CR1_CEN) && (ARGB_Sim_TIM[i].DIER & TIM_DIER_UDE)) k = i;
+    return k ? ARGB_Sim_PeriodCycles(k) : 1;
+}
+
+void ARGB_Sim_SetTimIRQ(const TIM_TypeDef *tim, void (*handler)(void)) {
+    for (int i = 1; i < 9; i++)
+        if (tim == &ARGB_Sim_TIM[i]) s_tim_irq[i] = handler;
+}
+
+/// Deliver the update interrupt of every running timer that has it enabled,
+/// one period after now
+static void ARGB_Sim_RunTimers(void) {
+    for (int i = 1; i < 9; i++) {
+        TIM_TypeDef *tim = &ARGB_Sim_TIM[i];
+        if (!s_tim_irq[i] || !(tim->CR1 & TIM_CR1_CEN) || !(tim->DIER & TIM_DIER_UIE)) continue;
+        ARGB_Sim_DWT.CYCCNT += ARGB_Sim_PeriodCycles(i);
+        tim->SR |= TIM_FLAG_UPDATE;
+        s_tim_irq[i]();
+    }
+}
+
+uint32_t ARGB_Sim_RunDMA(DMA_HandleTypeDef *hdma) {
+    ARGB_SimStream *st = ARGB_Sim_Find(hdma, 0);
+    uint32_t moved = 0;
+    if (st == NULL) return 0;
+
+    while (hdma->State == HAL_DMA_STATE_BUSY && moved < ARGB_SIM_MAX_XFER) {
+        const uint32_t msize = ARGB_Sim_Width(hdma->Init.MemDataAlignment,
+                                              DMA_MDATAALIGN_HALFWORD, DMA_MDATAALIGN_WORD);
+        const uint32_t len = st->len;
+        const uint32_t starts = st->starts;
+        const uint32_t cycles = ARGB_Sim_ElementCycles(st);
+        for (uint32_t i = 0; i < len; i++) {
+            ARGB_Sim_DWT.CYCCNT += cycles;
+            const uint8_t *src = (const uint8_t *) st->src + i * msize;
+            uint32_t val = msize == 4 ? *(const uint32_t *) src :
+                           msize == 2 ? *(const uint16_t *) src : *src;
+            *(volatile uint32_t *) st->dst = val; // zero-extended peripheral write
+            ARGB_Sim_Push(st, val);
+            moved++;
+            if (i + 1 == len / 2 && hdma->XferHalfCpltCallback) {
+                hdma->XferHalfCpltCallback(hdma);
+                ARGB_Sim_RunTimers();
+            }
+            if (hdma->State != HAL_DMA_STATE_BUSY) return moved; // aborted
+            if (st->starts != starts) break; // aborted and restarted from HT
+        }
+        if (st->starts != starts) continue;
+        if (hdma->Init.Mode != DMA_CIRCULAR) hdma->State = HAL_DMA_STATE_READY;
+        if (hdma->XferCpltCallback) hdma->XferCpltCallback(hdma);
+        ARGB_Sim_RunTimers();
+        // Restarted from the callback: keep going with the new transfer
+        if (hdma->Init.Mode != DMA_CIRCULAR && st->starts == starts) break;
+    }
+    return moved;
+}
+
+uint32_t ARGB_Sim_RunAll(void) {
+    uint32_t moved = 0;
+    for (int i = 0; i < ARGB_SIM_MAX_DMA; i++)
+        if (s_streams[i].hdma) moved += ARGB_Sim_RunDMA(s_streams[i].hdma);
+    return moved;
+}
+
+const uint32_t *ARGB_Sim_Capture(const DMA_HandleTypeDef *hdma, uint32_t *len) {
+    ARGB_SimStream *st = ARGB_Sim_Find(hdma, 0);
+    if (len) *len = st ? st->cap_len : 0;
+    return st ? st->cap : NULL;
+}
+
+void ARGB_Sim_ClearCapture(const DMA_HandleTypeDef *hdma) {
+    ARGB_SimStream *st = ARGB_Sim_Find(hdma, 0);
+    if (st) st->cap_len = 0;
+}
+
+uint32_t ARGB_Sim_Starts(const DMA_HandleTypeDef *hdma) {
+    ARGB_SimStream *st = ARGB_Sim_Find(hdma, 0);
+    return st ? st->starts : 0;
+}
+
+uint32_t ARGB_Sim_Decode(const DMA_HandleTypeDef *hdma, uint32_t lo, uint32_t hi,
+                         uint8_t *out, uint32_t max_bytes) {
+    return ARGB_Sim_DecodeStride(hdma, 0, 1, lo, hi, out, max_bytes);
+}
+
+uint32_t ARGB_Sim_DecodeStride(const DMA_HandleTypeDef *hdma, uint32_t first, uint32_t stride,
+                               uint32_t lo, uint32_t hi, uint8_t *out, uint32_t max_bytes) {
+    uint32_t len, n = 0;
+    const uint32_t *cap = ARGB_Sim_Capture(hdma, &len);
+    for (uint32_t i = first; i + 7 * stride < len && n < max_bytes; i += 8 * stride) {
+        uint8_t byte = 0;
+        for (uint32_t b = 0; b < 8; b++) {
+            const uint32_t v = cap[i + b * stride];
+            if (v == hi) byte |= 0x80 >> b;
+            else if (v != lo) return n; // reset period or garbage
+        }
+        out[n++] = byte;
+    }
+    return n;
+}
+
+uint32_t ARGB_Sim_DecodeBSRR(const DMA_HandleTypeDef *hdma, uint8_t pin,
+                             uint8_t *out, uint32_t max_bytes) {
+    // Pin level is replayed from set/reset writes, every write is one slot.
+    // A pulse of one slot is a 0 bit, longer pulses are 1 bits.
+    uint32_t len, n = 0, bit = 0, rise = 0;
+    int high = 0;
+    const uint32_t *cap = ARGB_Sim_Capture(hdma, &len);
+    const uint32_t set = 1UL << pin, reset = set << 16;
+    for (uint32_t i = 0; i < len && n < max_bytes; i++) {
+        if (!high && (cap[i] & set)) {
+            high = 1;
+            rise = i;
+        } else if (high && (cap[i] & reset)) {
+            high = 0;
+            if (bit == 0) out[n] = 0;
+            if (i - rise > 1) out[n] |= 0x80 >> bit;
+            if (++bit == 8) {
+                bit = 0;
+                n++;
+            }
+        }
+    }
+    return n;
+}
+
+uint32_t ARGB_Sim_TrailingZeros(const DMA_HandleTypeDef *hdma) {
+    uint32_t len, n = 0;
+    const uint32_t *cap = ARGB_Sim_Capture(hdma, &len);
+    while (n < len && cap[len - 1 - n] == 0) n++;
+    return n;
+}
+
+// ---- HAL stand-ins ----
+
+uint32_t HAL_RCC_GetPCLK1Freq(void) { return ARGB_SIM_PCLK1; }
+uint32_t HAL_RCC_GetPCLK2Freq(void) { return ARGB_SIM_PCLK2; }
+void HAL_Delay(uint32_t Delay) { ARGB_Sim_Tick += Delay; }
+uint32_t HAL_GetTick(void) { return ARGB_Sim_Tick; }
+
+void TIM_CCxChannelCmd(TIM_TypeDef *TIMx, uint32_t Channel, uint32_t ChannelState) {
+    uint32_t bit = 1UL << (Channel & 0x1FU);
+    TIMx->CCER = (TIMx->CCER & ~bit) | (ChannelState ? bit : 0);
+}
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma) {
+    if (hdma == NULL) return HAL_ERROR;
+    hdma->State = HAL_DMA_STATE_READY;
+    hdma->ErrorCode = 0;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_Start_IT(DMA_HandleTypeDef *hdma, uint32_t SrcAddress,
+                                   uint32_t DstAddress, uint32_t DataLength) {
+    ARGB_SimStream *st = ARGB_Sim_Find(hdma, 1);
+    if (st == NULL || DataLength == 0) return HAL_ERROR;
+    if (hdma->State != HAL_DMA_STATE_READY) return HAL_BUSY;
+    st->src = (uintptr_t) ARGB_Sim_Ptr(SrcAddress);
+    st->dst = (uintptr_t) ARGB_Sim_Ptr(DstAddress);
+    st->len = DataLength;
+    st->starts++;
+    hdma->State = HAL_DMA_STATE_BUSY;
+    return HAL_OK;
+}
+
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef *hdma) {
+    if (hdma->State != HAL_DMA_STATE_BUSY) return HAL_ERROR;
+    hdma->State = HAL_DMA_STATE_READY;
+    return HAL_OK;
+}
+
+void TIM_DMAError(DMA_HandleTypeDef *hdma) {
+    TIM_HandleTypeDef *htim = (TIM_HandleTypeDef *) hdma->Parent;
+    hdma->State = HAL_DMA_STATE_READY;
+    if (htim) htim->Channel = HAL_TIM_ACTIVE_CHANNEL_CLEARED;
+}
@@ -0,0 +1,69 @@
+/**
+ *******************************************
+ * @file    ARGB_Sim.h
+ * @brief   Host simulation backend for ARGB Driver
+ *******************************************
+ *
+ * @note Pulled in by the stand-in main.h, so a host build of ARGB.c only
+ *       needs -Iextras/sim. HAL_DMA_Start_IT() arms a transfer, nothing
+ *       moves until ARGB_Sim_RunDMA() is called: every element is written
+ *       to the destination register (CCR, DMAR, BSRR...) and appended to a
+ *       capture, HT/TC callbacks are delivered at the exact element counts.
+ *
+ * @note Timer update interrupts (ARGB_USE_HW_LATCH) fire one timer period
+ *       after a DMA callback enabled them, if a handler is registered with
+ *       ARGB_Sim_SetTimIRQ() - the stand-in for the vector table.
+ *
+ * @note DWT->CYCCNT is a virtual core clock: every DMA element advances it by
+ *       one period of the pacing timer, CPU work takes no time. Timelines of
+ *       the trace ring (ARGB_USE_TRACE) are deterministic.
+ *
+ * @note On 64-bit hosts the HAL passes addresses as 32-bit values, the upper
+ *       half is restored from the executable's own data segment. Keep DMA
+ *       source buffers static (as the driver does).
+ */
+
+#ifndef ARGB_SIM_H_
+#define ARGB_SIM_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct __DMA_HandleTypeDef;
+struct ARGB_SimTIM;
+
+#define ARGB_SIM_MAX_DMA 16             ///< Simultaneously tracked DMA handles
+#define ARGB_SIM_MAX_XFER (1UL << 24)   ///< Runaway guard for circular transfers
+#define ARGB_SIM_PCLK1 42000000UL       ///< APB1 clock (timer clock x2 = 84 MHz)
+#define ARGB_SIM_PCLK2 84000000UL       ///< APB2 clock (timer clock x2 = 168 MHz)
+#define ARGB_SIM_SYSCLK 168000000UL     ///< Core clock, DWT->CYCCNT rate
+
+void ARGB_Sim_Reset(void); // Reset registers, captures and legacy handles
+
+uint32_t ARGB_Sim_RunDMA(struct __DMA_HandleTypeDef *hdma); // Run armed transfer until the stream stops
+uint32_t ARGB_Sim_RunAll(void); // Run every armed stream
+void ARGB_Sim_SetTimIRQ(const struct ARGB_SimTIM *tim, void (*handler)(void)); // Timer update IRQ handler, NULL - none
+
+const uint32_t *ARGB_Sim_Capture(const struct __DMA_HandleTypeDef *hdma, uint32_t *len); // Values written by DMA
+void ARGB_Sim_ClearCapture(const struct __DMA_HandleTypeDef *hdma); // Drop captured values
+uint32_t ARGB_Sim_Starts(const struct __DMA_HandleTypeDef *hdma); // HAL_DMA_Start_IT() calls so far
+
+uint32_t ARGB_Sim_Decode(const struct __DMA_HandleTypeDef *hdma, uint32_t lo, uint32_t hi,
+                         uint8_t *out, uint32_t max_bytes); // Captured PWM slots -> bytes
+uint32_t ARGB_Sim_DecodeStride(const struct __DMA_HandleTypeDef *hdma, uint32_t first, uint32_t stride,
+                               uint32_t lo, uint32_t hi, uint8_t *out,
+                               uint32_t max_bytes); // Same for one channel of an interleaved (DMAR burst) capture
+uint32_t ARGB_Sim_DecodeBSRR(const struct __DMA_HandleTypeDef *hdma, uint8_t pin,
+                             uint8_t *out, uint32_t max_bytes); // Captured BSRR writes -> bytes of one pin
+uint32_t ARGB_Sim_TrailingZeros(const struct __DMA_HandleTypeDef *hdma); // Reset slots at capture end
+
+void *ARGB_Sim_Ptr(uint32_t addr); // Restore host pointer from HAL address
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ARGB_SIM_H_ */
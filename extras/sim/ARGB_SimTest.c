@@ -0,0 +1,809 @@
+/**
+ *******************************************
+ * @file    ARGB_SimTest.c
+ * @brief   Wire-level tests of ARGB Driver on the host simulation
+ *******************************************
+ *
+ * @note Every frame is decoded back from the captured PWM slots (BSRR writes for
+ *       parallel groups) and compared with the colours that were set: full,
+ *       prefix, queued, burst and parallel frames, the reset period and the
+ *       DWT stats. One binary = one configuration (family, streaming, hardware
+ *       latch, queue), run.sh builds and runs the whole matrix.
+ * @note Usage: sim_test, exit code 0 if every check passed
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "main.h"
+#include "ARGB.h"
+#if ARGB_USE_TRACE
+#include "ARGB_TraceJSON.h"
+#endif
+
+#if USE_GAMMA_CORRECTION
+#error Frames are compared with the raw colours, build without USE_GAMMA_CORRECTION
+#endif
+
+#define TEST_BYTES (NUM_PIXELS * ARGB_BYTES_PER_PIXEL) ///< Wire bytes of the default strip
+#define TEST_FRAMES 8   ///< Frames tracked per test
+#define TEST_LANES 4    ///< Parallel lanes / burst channels
+
+extern TIM_HandleTypeDef htim2;
+extern DMA_HandleTypeDef hdma_tim2_ch2_ch4;
+
+ARGB_PAR_DEF(wall, TEST_LANES, NUM_PIXELS);
+static TIM_HandleTypeDef wall_htim;
+static DMA_HandleTypeDef wall_hdma;
+
+ARGB_BURST_DEF(quad, TEST_LANES, NUM_PIXELS);
+static TIM_HandleTypeDef quad_htim;
+static DMA_HandleTypeDef quad_hdma;
+
+static u8_t desk_mem[16 * 1024]; ///< Arena of the runtime-sized strip
+static ARGB_Strip *desk;
+static TIM_HandleTypeDef desk_htim;
+static DMA_HandleTypeDef desk_hdma;
+
+#if !ARGB_USE_STREAMING
+/// Longest strips within / past one DMA transfer
+#define TEST_MAX_PIXELS ((ARGB_DMA_MAX_XFER - ARGB_RST_SLOTS) / (ARGB_BYTES_PER_PIXEL * 8))
+ARGB_STRIP_DEF(longest, TEST_MAX_PIXELS);
+ARGB_STRIP_DEF(too_long, TEST_MAX_PIXELS + 1);
+static u8_t long_mem[(TEST_MAX_PIXELS + 1) * ARGB_BYTES_PER_PIXEL * 13 + 1024]; ///< PWM + dither + queue copy
+#endif
+
+/// Longest parallel group within / past one DMA transfer
+#define TEST_PAR_PIXELS ((ARGB_DMA_MAX_XFER / ARGB_PAR_SLOTS - ARGB_RST_LEN) / (ARGB_BYTES_PER_PIXEL * 8))
+ARGB_PAR_DEF(wall_max, 1, TEST_PAR_PIXELS);
+ARGB_PAR_DEF(wall_over, 1, TEST_PAR_PIXELS + 1);
+
+/// Longest burst group within / past one DMA transfer
+#define TEST_BURST_PIXELS ((ARGB_DMA_MAX_XFER / TEST_LANES - ARGB_RST_LEN) / (ARGB_BYTES_PER_PIXEL * 8))
+ARGB_BURST_DEF(quad_max, TEST_LANES, TEST_BURST_PIXELS);
+ARGB_BURST_DEF(quad_over, TEST_LANES, TEST_BURST_PIXELS + 1);
+
+static u8_t model[TEST_BYTES];      ///< Colours set so far, wire order
+static u32_t frame_end[TEST_FRAMES]; ///< Capture length at the end of each frame
+static u32_t frames;                 ///< Frames completed since test_begin()
+static unsigned failures;
+
+#define CHECK(cond) test_check((cond), #cond, __LINE__)
+
+static void test_check(int ok, const char *what, int line) {
+    if (ok) return;
+    printf("FAIL %s:%d: %s\n", __FILE__, line, what);
+    failures++;
+}
+
+/// Frame complete callback: remember where the frame ends in the capture
+static void test_on_done(ARGB_Strip *strip, void *ctx) {
+    (void) strip;
+    (void) ctx;
+    u32_t len;
+    ARGB_Sim_Capture(&hdma_tim2_ch2_ch4, &len);
+    if (frames < TEST_FRAMES) frame_end[frames] = len;
+    frames++;
+}
+
+/// Wire bytes of one pixel as ARGB_SetRGB() stores them at full brightness
+static void test_pack(u8_t *buf, u16_t i, u8_t r, u8_t g, u8_t b) {
+    u8_t *px = &buf[i * ARGB_BYTES_PER_PIXEL];
+    px[ARGB_LED_DEFAULT.order[0]] = r;
+    px[ARGB_LED_DEFAULT.order[1]] = g;
+    px[ARGB_LED_DEFAULT.order[2]] = b;
+}
+
+/// Set pixel i of the default strip and of the model
+static void test_set(u16_t i, u8_t r, u8_t g, u8_t b) {
+    ARGB_SetRGB(i, r, g, b);
+    test_pack(model, i, r, g, b);
+}
+
+/// Bytes decoded from frame k of the default strip
+static u32_t test_frame(u32_t k, u8_t *out) {
+    const u32_t first = k ? frame_end[k - 1] : 0;
+    const ARGB_Strip *strip = &ARGB_DefaultStrip;
+    return ARGB_Sim_DecodeStride(&hdma_tim2_ch2_ch4, first, 1, strip->pwm_lo, strip->pwm_hi,
+                                 out, TEST_BYTES);
+}
+
+/// Send everything armed, the driver starts queued frames from the callbacks
+static void test_run(void) {
+    ARGB_Sim_RunDMA(&hdma_tim2_ch2_ch4);
+}
+
+static void test_begin(const char *name) {
+    printf("test %s\n", name);
+    test_run(); // Leftovers of the last test
+    ARGB_Sim_ClearCapture(&hdma_tim2_ch2_ch4);
+    frames = 0;
+}
+
+// ---- Tests ----
+
+static void test_full(void) {
+    u8_t out[TEST_BYTES];
+    test_begin("full");
+    for (u16_t i = 0; i < NUM_PIXELS; i++)
+        test_set(i, (u8_t) (i * 37 + 1), (u8_t) (i * 11 + 2), (u8_t) (i * 5 + 3));
+    CHECK(ARGB_Show() == ARGB_OK);
+    CHECK(ARGB_Ready() == ARGB_BUSY);
+    test_run();
+    CHECK(frames == 1);
+    CHECK(ARGB_Ready() == ARGB_READY);
+    CHECK(ARGB_Sim_Decode(&hdma_tim2_ch2_ch4, ARGB_DefaultStrip.pwm_lo, ARGB_DefaultStrip.pwm_hi,
+                          out, TEST_BYTES) == TEST_BYTES);
+    CHECK(memcmp(out, model, TEST_BYTES) == 0);
+    CHECK(ARGB_Sim_TrailingZeros(&hdma_tim2_ch2_ch4) >= ARGB_RST_SLOTS);
+#if ARGB_USE_HW_LATCH && !ARGB_USE_STREAMING
+    CHECK(ARGB_Sim_TrailingZeros(&hdma_tim2_ch2_ch4) < ARGB_RST_LEN); // Timer holds the reset
+#endif
+
+#if ARGB_SKIP_UNCHANGED
+    const u32_t starts = ARGB_Sim_Starts(&hdma_tim2_ch2_ch4);
+    CHECK(ARGB_Show() == ARGB_OK); // Unchanged frame is not sent
+    CHECK(ARGB_Sim_Starts(&hdma_tim2_ch2_ch4) == starts);
+#else
+    ARGB_Sim_ClearCapture(&hdma_tim2_ch2_ch4);
+    CHECK(ARGB_Show() == ARGB_OK); // Unchanged frame is sent again
+    test_run();
+    CHECK(ARGB_Sim_Decode(&hdma_tim2_ch2_ch4, ARGB_DefaultStrip.pwm_lo, ARGB_DefaultStrip.pwm_hi,
+                          out, TEST_BYTES) == TEST_BYTES);
+    CHECK(memcmp(out, model, TEST_BYTES) == 0);
+#endif
+}
+
+/// Pixels set before ARGB_Init() keep their colour
+static void test_early(void) {
+    u8_t out[TEST_BYTES];
+    test_begin("early");
+    CHECK(ARGB_Show() == ARGB_OK);
+    test_run();
+    CHECK(frames == 1);
+    CHECK(test_frame(0, out) == TEST_BYTES);
+    CHECK(memcmp(out, model, TEST_BYTES) == 0);
+    CHECK(wall.rgb_buf[ARGB_LED_DEFAULT.order[0]] == 0x44);
+    CHECK(quad.rgb_buf[ARGB_LED_DEFAULT.order[2]] == 0x99);
+}
+
+static void test_brightness(void) {
+    u8_t out[TEST_BYTES];
+    test_begin("brightness");
+    ARGB_SetBrightness(64);
+    ARGB_SetRGB(1, 200, 100, 4); // Whole levels at quarter brightness, no dither fraction
+    test_pack(model, 1, 50, 25, 1);
+    ARGB_SetBrightness(255);
+    CHECK(ARGB_Show() == ARGB_OK);
+    test_run();
+    CHECK(test_frame(0, out) == TEST_BYTES);
+    CHECK(memcmp(out, model, TEST_BYTES) == 0);
+}
+
+#if ARGB_USE_DITHER
+/// A fractional level alternates between its neighbours, averaging to the 8.8 level
+static void test_dither(void) {
+    u8_t out[TEST_BYTES];
+    u32_t sum = 0, seen = 0;
+    const u8_t red = ARGB_LED_DEFAULT.order[0];
+    test_begin("dither");
+    ARGB_SetBrightness(10);
+    ARGB_SetRGB(0, 100, 0, 0); // 100 * 10 / 256 = 3.906
+    ARGB_SetBrightness(255);
+    memset(out, 0, sizeof(out));
+    for (u32_t k = 0; k < TEST_FRAMES; k++) {
+        CHECK(ARGB_Show() == ARGB_OK);
+        test_run();
+        // ARGB_SKIP_UNCHANGED sends only frames whose output changed, the LED keeps the last one
+        if (frames > seen) {
+            seen = frames;
+            CHECK(test_frame(frames - 1, out) == TEST_BYTES);
+        }
+        CHECK(out[red] == 3 || out[red] == 4);
+        sum += out[red];
+    }
+    CHECK(seen >= 2); // Both neighbours were sent
+    CHECK(sum * 256 + 256 > TEST_FRAMES * 1000 && sum * 256 < TEST_FRAMES * 1000 + 256);
+
+    // Bytes written straight into RGB_BUF become the levels, no stale fraction
+    ARGB_DefaultStrip.rgb_buf[red] = 0x42;
+    model[red] = 0x42;
+    model[ARGB_LED_DEFAULT.order[1]] = 0;
+    model[ARGB_LED_DEFAULT.order[2]] = 0;
+    ARGB_Invalidate();
+    ARGB_Sim_ClearCapture(&hdma_tim2_ch2_ch4);
+    frames = 0;
+    CHECK(ARGB_Show() == ARGB_OK);
+    test_run();
+    CHECK(test_frame(0, out) == TEST_BYTES);
+    CHECK(memcmp(out, model, TEST_BYTES) == 0);
+}
+#endif
+
+/// Hue ramp: the same bytes as ARGB_SetHSV() per LED, clipped to the strip end
+static void test_rainbow(void) {
+    u8_t out[TEST_BYTES], ref[TEST_BYTES];
+    const u16_t first = 4;
+    test_begin("rainbow");
+    ARGB_FillRainbow(first, NUM_PIXELS, 200, 40, 255, 255); // Past the end, hue wraps
+    CHECK(ARGB_Show() == ARGB_OK);
+    test_run();
+    CHECK(test_frame(0, out) == TEST_BYTES);
+    CHECK(memcmp(out, model, first * ARGB_BYTES_PER_PIXEL) == 0); // LEDs before the range kept
+
+    for (u16_t i = first; i < NUM_PIXELS; i++)
+        ARGB_SetHSV(i, (u8_t) (200 + 40 * (i - first)), 255, 255);
+    CHECK(ARGB_Show() == ARGB_OK);
+    test_run();
+    CHECK(test_frame(1, ref) == TEST_BYTES);
+    CHECK(memcmp(out, ref, TEST_BYTES) == 0);
+    memcpy(model, ref, TEST_BYTES);
+
+    // Sector anchors are exact in both HSV conversions
+    ARGB_FillRainbow(0, 2, 0, 85, 255, 255); // Red, green
+    ARGB_FillRainbow(2, 1, 123, 0, 0, 77);   // No saturation: grey
+    test_pack(model, 0, 255, 0, 0);
+    test_pack(model, 1, 0, 255, 0);
+    test_pack(model, 2, 77, 77, 77);
+    CHECK(ARGB_Show() == ARGB_OK);
+    test_run();
+    CHECK(test_frame(2, out) == TEST_BYTES);
+    CHECK(memcmp(out, model, TEST_BYTES) == 0);
+}
+
+/// Packed spans: brightness, wire order and white applied, clipped to the strip end
+static void test_write_pixels(void) {
+    u8_t out[TEST_BYTES], rgb[NUM_PIXELS * 3];
+    const u8_t rgbw[2 * 4] = { 1, 2, 3, 4, 5, 6, 7, 8 };
+    const u32_t wrgb[3] = { 0x44332211UL, 0x88776655UL, 0xCCBBAA99UL };
+    test_begin("write_pixels");
+    for (u16_t i = 0; i < NUM_PIXELS * 3; i++) rgb[i] = (u8_t) (i * 13 + 7);
+    ARGB_WritePixels(2, rgb, NUM_PIXELS); // Past the end
+    for (u16_t i = 2; i < NUM_PIXELS; i++)
+        test_pack(model, i, rgb[(i - 2) * 3], rgb[(i - 2) * 3 + 1], rgb[(i - 2) * 3 + 2]);
+    ARGB_WritePixels(NUM_PIXELS, rgb, 1); // Nothing inside the strip
+
+    ARGB_WritePixelsRGBW(0, rgbw, 2);
+    ARGB_WritePixels32(NUM_PIXELS - 1, wrgb, 3);
+    test_pack(model, 0, 1, 2, 3);
+    test_pack(model, 1, 5, 6, 7);
+    test_pack(model, NUM_PIXELS - 1, 0x33, 0x22, 0x11);
+#if ARGB_BYTES_PER_PIXEL == 4 // RGB strips drop the white bytes
+    model[0 * 4 + ARGB_LED_DEFAULT.order[3]] = 4;
+    model[1 * 4 + ARGB_LED_DEFAULT.order[3]] = 8;
+    model[(NUM_PIXELS - 1) * 4 + ARGB_LED_DEFAULT.order[3]] = 0x44;
+#endif
+
+    rgb[0] = 200, rgb[1] = 100, rgb[2] = 4;
+    ARGB_SetBrightness(64);
+    ARGB_WritePixels(3, rgb, 1); // Quarter brightness, whole levels
+    ARGB_SetBrightness(255);
+    test_pack(model, 3, 50, 25, 1);
+
+    CHECK(ARGB_Show() == ARGB_OK);
+    test_run();
+    CHECK(test_frame(0, out) == TEST_BYTES);
+    CHECK(memcmp(out, model, TEST_BYTES) == 0);
+}
+
+/// Bound framebuffers are sent as they are and written by the Set functions
+static void test_swap_buffer(void) {
+    static u8_t fb[ARGB_FB_BYTES(NUM_PIXELS)];
+    u8_t out[TEST_BYTES];
+    test_begin("swap_buffer");
+    for (u16_t i = 0; i < TEST_BYTES; i++) fb[i] = (u8_t) (0xA5 ^ (i * 3));
+    u8_t *const prev = ARGB_SwapBuffer(fb);
+    CHECK(prev != NULL && prev != fb);
+    CHECK(ARGB_SwapBuffer(NULL) == NULL); // Binding kept
+    CHECK(ARGB_Show() == ARGB_OK);
+    test_run();
+    CHECK(test_frame(0, out) == TEST_BYTES);
+    CHECK(memcmp(out, fb, TEST_BYTES) == 0);
+
+    ARGB_SetRGB(1, 0x10, 0x20, 0x30); // Lands in fb, the old buffer keeps the model
+    CHECK(ARGB_Show() == ARGB_OK);
+    test_run();
+    CHECK(fb[ARGB_BYTES_PER_PIXEL + ARGB_LED_DEFAULT.order[0]] == 0x10);
+    CHECK(fb[ARGB_BYTES_PER_PIXEL + ARGB_LED_DEFAULT.order[2]] == 0x30);
+    CHECK(test_frame(1, out) == TEST_BYTES);
+    CHECK(memcmp(out, fb, TEST_BYTES) == 0);
+
+    CHECK(ARGB_SwapBuffer(prev) == fb);
+    CHECK(ARGB_Show() == ARGB_OK);
+    test_run();
+    CHECK(test_frame(2, out) == TEST_BYTES);
+    CHECK(memcmp(out, model, TEST_BYTES) == 0);
+}
+
+#define TEST_FPS 100 ///< Pacer rate, 10 ms period
+
+static u32_t test_us;      ///< Virtual microsecond clock of the pacer
+static u32_t test_work_us; ///< Render time added by test_render()
+
+static u32_t test_micros(void) {
+    return test_us;
+}
+
+/// Render hook: pixel 0 red = frame number
+static void test_render(ARGB_Strip *strip, void *ctx) {
+    u32_t *n = (u32_t *) ctx;
+    (*n)++;
+    ARGB_SetRGB_Ex(strip, 0, (u8_t) *n, 0, 0);
+    test_pack(model, 0, (u8_t) *n, 0, 0);
+    test_us += test_work_us;
+}
+
+/// Tick at virtual time t, optionally let the frame go out before the next tick
+static void test_tick(ARGB_Pacer *pacer, u32_t t, int send) {
+    test_us = t;
+    ARGB_PacerTick(pacer);
+    if (send) test_run();
+}
+
+/// Frame rendered in one period goes out at the next tick; jitter, misses and wire time
+static void test_pacer(void) {
+    ARGB_Pacer pacer;
+    ARGB_PacerStats st;
+    u8_t out[TEST_BYTES];
+    u32_t rendered = 0;
+    const u32_t period = 1000000UL / TEST_FPS;
+    test_begin("pacer");
+    test_work_us = 50;
+    CHECK(ARGB_PacerInit(&pacer, &ARGB_DefaultStrip, 0, test_render, &rendered, test_micros) == ARGB_PARAM_ERR);
+    CHECK(ARGB_PacerInit(&pacer, &ARGB_DefaultStrip, TEST_FPS, test_render, &rendered, test_micros) == ARGB_OK);
+
+    const u32_t at[4] = { 0, period, 2 * period + 3, 3 * period + 1 }; // Intervals P, P + 3, P - 2
+    for (u32_t k = 0; k < 4; k++) {
+        test_tick(&pacer, at[k], k < 3);
+        CHECK(rendered == k + 1);
+        if (k == 0 || k == 3) continue;
+        CHECK(frames >= 1 && test_frame(frames - 1, out) == TEST_BYTES);
+        CHECK(out[ARGB_LED_DEFAULT.order[0]] == k); // Rendered one period earlier
+    }
+    test_tick(&pacer, 4 * period, 1); // Frame 3 still on the wire: missed
+    test_work_us = period + 1;
+    test_tick(&pacer, 5 * period, 1); // Render overruns the period: missed
+
+    ARGB_PacerGetStats(&pacer, &st);
+    CHECK(st.frames == 6);
+    CHECK(st.missed == 2);
+    CHECK(st.period_us == period);
+    CHECK(st.jitter_max_us == 3);
+    CHECK(st.jitter_avg_us == (0 + 3 + 2 + 1 + 0) / 5);
+    CHECK(st.work_max_us == period + 1);
+    const u32_t wire = (u32_t) ((TEST_BYTES * 8 + ARGB_RST_LEN) * 1000000ULL / ARGB_LED_DEFAULT.bit_hz);
+    CHECK(st.wire_us + 1 >= wire && st.wire_us <= wire + 1);
+    CHECK(st.headroom_us == -1);
+    ARGB_PacerResetStats(&pacer);
+    ARGB_PacerGetStats(&pacer, &st);
+    CHECK(st.frames == 0 && st.missed == 0 && st.work_max_us == 0);
+}
+
+static void test_prefix(void) {
+    u8_t out[TEST_BYTES];
+    test_begin("prefix");
+    test_set(2, 0x12, 0x34, 0x56);
+    CHECK(ARGB_ShowPrefix() == ARGB_OK);
+    test_run();
+    CHECK(frames == 1);
+    CHECK(test_frame(0, out) == 3 * ARGB_BYTES_PER_PIXEL); // Up to the changed pixel
+    CHECK(memcmp(out, model, 3 * ARGB_BYTES_PER_PIXEL) == 0);
+    CHECK(ARGB_Sim_TrailingZeros(&hdma_tim2_ch2_ch4) >= ARGB_RST_SLOTS);
+
+    // Pixels under the reset period of the prefix are restored in the next full frame
+    test_set(NUM_PIXELS - 1, 0x78, 0x9A, 0xBC);
+    CHECK(ARGB_Show() == ARGB_OK);
+    test_run();
+    CHECK(frames == 2);
+    CHECK(test_frame(1, out) == TEST_BYTES);
+    CHECK(memcmp(out, model, TEST_BYTES) == 0);
+}
+
+#if ARGB_USE_QUEUE
+static void test_queue(void) {
+    u8_t out[TEST_BYTES];
+    test_begin("queue");
+    test_set(0, 1, 2, 3);
+    CHECK(ARGB_Show() == ARGB_OK);
+    test_set(1, 4, 5, 6);
+    CHECK(ARGB_ShowPrefix() == ARGB_OK); // Queued behind the frame on the wire
+    test_set(NUM_PIXELS - 1, 7, 8, 9);   // After the queued Show
+    test_run();
+    CHECK(frames == 2);
+    CHECK(test_frame(1, out) == 2 * ARGB_BYTES_PER_PIXEL);
+    CHECK(memcmp(out, model, 2 * ARGB_BYTES_PER_PIXEL) == 0);
+
+    // The last pixel was never sent: it must still be pending
+    CHECK(ARGB_Show() == ARGB_OK);
+    test_run();
+    CHECK(frames == 3);
+    CHECK(test_frame(2, out) == TEST_BYTES);
+    CHECK(memcmp(out, model, TEST_BYTES) == 0);
+}
+#endif
+
+#if ARGB_QUEUE_COPY
+static void test_snapshot(void) {
+    u8_t out[TEST_BYTES], shown[TEST_BYTES];
+    test_begin("snapshot");
+    test_set(0, 10, 20, 30);
+    CHECK(ARGB_Show() == ARGB_OK);
+    test_set(0, 40, 50, 60);
+    test_set(NUM_PIXELS / 2, 70, 80, 90);
+    CHECK(ARGB_Show() == ARGB_OK); // Queued: takes the frame as it is now
+    memcpy(shown, model, TEST_BYTES);
+    test_set(0, 11, 22, 33);       // Render loop draws the next frame
+    test_set(NUM_PIXELS / 2, 44, 55, 66);
+    test_run();
+    CHECK(frames == 2);
+    CHECK(test_frame(1, out) == TEST_BYTES);
+    CHECK(memcmp(out, shown, TEST_BYTES) == 0);
+
+    CHECK(ARGB_Show() == ARGB_OK);
+    test_run();
+    CHECK(frames == 3);
+    CHECK(test_frame(2, out) == TEST_BYTES);
+    CHECK(memcmp(out, model, TEST_BYTES) == 0);
+}
+#endif
+
+#if ARGB_USE_STATS
+static void test_stats(void) {
+    ARGB_Stats st;
+    test_begin("stats");
+    ARGB_ResetStats();
+    ARGB_Invalidate();
+    CHECK(ARGB_Show() == ARGB_OK);
+    test_run();
+    ARGB_GetStats(&st);
+    CHECK(st.frames == 1);
+    CHECK(st.busy == 0 && st.dma_errors == 0);
+    // Wire time from DWT->CYCCNT: one bit period per data slot, plus the reset
+    const u32_t bit_cycles = ARGB_SIM_SYSCLK / ARGB_LED_DEFAULT.bit_hz;
+    CHECK(st.wire_cycles >= (u32_t) TEST_BYTES * 8 * bit_cycles);
+    CHECK(st.wire_cycles <= (u32_t) (TEST_BYTES * 8 + ARGB_PWM_SLOTS(0) + 2 * ARGB_RST_LEN) * bit_cycles);
+    CHECK(st.wire_max == st.wire_cycles);
+}
+#endif
+
+#if ARGB_USE_TRACE
+/// Occurrences of s in text
+static u32_t test_count(const char *text, const char *s) {
+    u32_t n = 0;
+    for (const char *p = strstr(text, s); p; p = strstr(p + 1, s)) n++;
+    return n;
+}
+
+/// One frame leaves Show .. frame done in order; the ring keeps the newest events and
+/// the Chrome JSON export has balanced wire spans
+static void test_trace(void) {
+    static ARGB_TraceEvent ev[ARGB_TRACE_LEN];
+    static char json[64 * 1024];
+    const u8_t order[] = { ARGB_EV_SHOW, ARGB_EV_ENCODE_BEGIN, ARGB_EV_ENCODE_END,
+                           ARGB_EV_DMA_START, ARGB_EV_DMA_CPLT, ARGB_EV_FRAME_DONE };
+    u32_t next = 0, start = 0, done = 0;
+    test_begin("trace");
+    ARGB_TraceClear();
+    CHECK(ARGB_TraceRead(ev, ARGB_TRACE_LEN) == 0);
+    ARGB_Invalidate();
+    CHECK(ARGB_Show() == ARGB_OK);
+    test_run();
+    const u16_t n = ARGB_TraceRead(ev, ARGB_TRACE_LEN);
+    CHECK(n >= sizeof(order));
+    for (u16_t i = 0; i < n; i++) {
+        CHECK(ev[i].obj == &ARGB_DefaultStrip);
+        CHECK(i == 0 || ev[i].t >= ev[i - 1].t);
+        if (next < sizeof(order) && ev[i].ev == order[next]) next++;
+        if (ev[i].ev == ARGB_EV_DMA_START) start = ev[i].t, CHECK(ev[i].arg == TEST_BYTES);
+        if (ev[i].ev == ARGB_EV_FRAME_DONE) done = ev[i].t;
+    }
+    CHECK(next == sizeof(order));
+    CHECK(ev[0].ev == ARGB_EV_SHOW && ev[0].arg == TEST_BYTES);
+    CHECK(ev[n - 1].ev == ARGB_EV_FRAME_DONE);
+    CHECK(done - start >= (u32_t) TEST_BYTES * 8 * (ARGB_SIM_SYSCLK / ARGB_LED_DEFAULT.bit_hz));
+
+    // Wrap the ring: the oldest events are dropped, the rest stay in order
+    for (u32_t k = 0; k < ARGB_TRACE_LEN / 4; k++) {
+        ARGB_Invalidate();
+        CHECK(ARGB_Show() == ARGB_OK);
+        test_run();
+    }
+    CHECK(ARGB_TraceRead(ev, ARGB_TRACE_LEN) == ARGB_TRACE_LEN);
+    for (u16_t i = 1; i < ARGB_TRACE_LEN; i++) CHECK(ev[i].t >= ev[i - 1].t);
+    CHECK(ev[ARGB_TRACE_LEN - 1].ev == ARGB_EV_FRAME_DONE);
+
+    // Export from inside a frame: its wire span has lost the begin
+    u16_t cut = 0;
+    while (cut < ARGB_TRACE_LEN - 1 && ev[cut].ev != ARGB_EV_DMA_START) cut++;
+    cut++;
+    FILE *f = tmpfile();
+    CHECK(f != NULL);
+    if (f == NULL) return;
+    CHECK(ARGB_TraceJSON(f, ev + cut, ARGB_TRACE_LEN - cut, 0) == -1);
+    CHECK(ARGB_TraceJSON(f, ev + cut, ARGB_TRACE_LEN - cut, ARGB_SIM_SYSCLK / 1000000UL) == 0);
+    rewind(f);
+    const size_t len = fread(json, 1, sizeof(json) - 1, f);
+    fclose(f);
+    json[len] = 0;
+    CHECK(strncmp(json, "{\"traceEvents\":[", 16) == 0);
+    CHECK(len > 2 && strcmp(json + len - 2, "}\n") == 0);
+    const u32_t begins = test_count(json, "\"name\":\"wire\",\"ph\":\"B\"");
+    const u32_t ends = test_count(json, "\"name\":\"wire\",\"ph\":\"E\"");
+    CHECK(ends > 0 && begins == ends); // The cut frame's end is dropped
+    CHECK(test_count(json, "\"ph\":\"M\"") == 3); // One strip: CPU + wire tracks, process
+}
+#endif
+
+/// Switching LED chip retimes the bits and repacks the pixels of the next frame
+static void test_led_type(void) {
+    static const ARGB_LedType *const types[] = {
+        &ARGB_LED_WS2811S, &ARGB_LED_WS2811F, &ARGB_LED_WS2812, &ARGB_LED_SK6812,
+    };
+    static const ARGB_LedType no_rate = { 0, 56, 28, 3, {1, 0, 2, 3} };
+    static const ARGB_LedType bad_order = { 800 * 1000, 56, 28, 3, {1, 0, 3, 2} };
+    ARGB_Strip *strip = &ARGB_DefaultStrip;
+    u8_t exp[NUM_PIXELS * 4], out[NUM_PIXELS * 4];
+    test_begin("led_type");
+
+    CHECK(ARGB_SetLedType(&no_rate) == ARGB_PARAM_ERR);
+    CHECK(ARGB_SetLedType(&bad_order) == ARGB_PARAM_ERR);
+    CHECK(strip->led == &ARGB_LED_DEFAULT);
+    for (u32_t t = 0; t < sizeof(types) / sizeof(types[0]); t++) {
+        const ARGB_LedType *led = types[t];
+        const u32_t bytes = (u32_t) NUM_PIXELS * led->bpp;
+        const u32_t period = 2 * ARGB_SIM_PCLK1 / led->bit_hz; // Timer ticks per bit
+        if (led->bpp > ARGB_MAX_BYTES_PER_PIXEL) { // Buffers are too small
+            CHECK(ARGB_SetLedType(led) == ARGB_PARAM_ERR);
+            CHECK(strip->led == &ARGB_LED_DEFAULT);
+            continue;
+        }
+        CHECK(ARGB_SetLedType(led) == ARGB_OK);
+        CHECK(TIM2->ARR == period - 1);
+        CHECK(strip->pwm_hi == period * led->t1h_pct / 100 - 1);
+        CHECK(strip->pwm_lo == period * led->t0h_pct / 100 - 1);
+
+        memset(exp, 0, sizeof(exp));
+        for (u16_t i = 0; i < NUM_PIXELS; i++) {
+            const u8_t r = (u8_t) (i * 29 + t), g = (u8_t) (i * 13 + 7), b = (u8_t) (t * 40 + i);
+            ARGB_SetRGB(i, r, g, b);
+            exp[i * led->bpp + led->order[0]] = r;
+            exp[i * led->bpp + led->order[1]] = g;
+            exp[i * led->bpp + led->order[2]] = b;
+            if (led->bpp == 4) {
+                ARGB_SetWhite(i, (u8_t) (i + 100));
+                exp[i * led->bpp + led->order[3]] = (u8_t) (i + 100);
+            }
+        }
+        ARGB_Sim_ClearCapture(&hdma_tim2_ch2_ch4);
+        CHECK(ARGB_Show() == ARGB_OK);
+        CHECK(ARGB_SetLedType(&ARGB_LED_DEFAULT) == ARGB_BUSY); // Not while on the wire
+        test_run();
+        CHECK(strip->led == led);
+        CHECK(ARGB_Sim_Decode(&hdma_tim2_ch2_ch4, period * led->t0h_pct / 100 - 1,
+                              period * led->t1h_pct / 100 - 1, out, sizeof(out)) == bytes);
+        CHECK(memcmp(out, exp, bytes) == 0);
+        CHECK(ARGB_Sim_TrailingZeros(&hdma_tim2_ch2_ch4) >= ARGB_RST_SLOTS);
+    }
+
+    // Back to the build type, pixels are set again in its layout
+    CHECK(ARGB_SetLedType(&ARGB_LED_DEFAULT) == ARGB_OK);
+    for (u16_t i = 0; i < NUM_PIXELS; i++) {
+        const u8_t *px = &model[i * ARGB_BYTES_PER_PIXEL];
+        ARGB_SetRGB(i, px[ARGB_LED_DEFAULT.order[0]], px[ARGB_LED_DEFAULT.order[1]],
+                    px[ARGB_LED_DEFAULT.order[2]]);
+#if ARGB_BYTES_PER_PIXEL == 4
+        ARGB_SetWhite(i, px[ARGB_LED_DEFAULT.order[3]]);
+#endif
+    }
+    ARGB_Sim_ClearCapture(&hdma_tim2_ch2_ch4);
+    CHECK(ARGB_Show() == ARGB_OK);
+    test_run();
+    CHECK(ARGB_Sim_Decode(&hdma_tim2_ch2_ch4, strip->pwm_lo, strip->pwm_hi, out, sizeof(out)) == TEST_BYTES);
+    CHECK(memcmp(out, model, TEST_BYTES) == 0);
+}
+
+#if ARGB_USE_HW_LATCH
+static void desk_tim_irq(void) {
+    ARGB_TIM_IRQHandler_Ex(desk);
+}
+#endif
+
+/// A strip carved from an arena at runtime runs like a static one
+static void test_arena(void) {
+    ARGB_Arena arena;
+    u8_t exp[NUM_PIXELS * 3], out[NUM_PIXELS * 3];
+    test_begin("arena");
+    const u32_t starts = ARGB_Sim_Starts(&hdma_tim2_ch2_ch4);
+    ARGB_ArenaInit(&arena, desk_mem + 1, sizeof(desk_mem) - 1); // Start is realigned
+    CHECK((uintptr_t) arena.base % sizeof(void *) == 0);
+    CHECK(arena.base > desk_mem && arena.base + arena.size <= desk_mem + sizeof(desk_mem));
+    CHECK(arena.used == 0);
+
+    const u32_t need = ARGB_ArenaStripBytes(NUM_PIXELS, &ARGB_LED_WS2812, 2);
+    CHECK(ARGB_ArenaStrip(&arena, 0, &ARGB_LED_WS2812, 2) == NULL);
+    CHECK(ARGB_ArenaStrip(&arena, NUM_PIXELS, &ARGB_LED_WS2812, 3) == NULL);
+    CHECK(arena.used == 0); // Nothing taken on failure
+    desk = ARGB_ArenaStrip(&arena, NUM_PIXELS, &ARGB_LED_WS2812, 2);
+    CHECK(desk != NULL);
+    if (desk == NULL) return;
+    CHECK(arena.used == need);
+    CHECK((uintptr_t) desk->pwm_buf % sizeof(void *) == 0);
+    CHECK(ARGB_SetLedType_Ex(desk, &ARGB_LED_SK6812) == ARGB_PARAM_ERR); // Sized for 3 bytes
+
+    // Exhausted: a second strip does not fit what is left
+    ARGB_Arena small = arena;
+    small.size = small.used + need - 1;
+    CHECK(ARGB_ArenaStrip(&small, NUM_PIXELS, &ARGB_LED_WS2812, 2) == NULL);
+    CHECK(small.used == need);
+
+    desk_htim.Instance = TIM3;
+    desk_hdma.Init.MemDataAlignment = DMA_MDATAALIGN_HALFWORD;
+#if ARGB_USE_STREAMING
+    desk_hdma.Init.Mode = DMA_CIRCULAR;
+#endif
+    HAL_DMA_Init(&desk_hdma);
+    CHECK(ARGB_Attach_Ex(desk, &desk_htim, TIM_CHANNEL_1, &desk_hdma, 2 * ARGB_SIM_PCLK1) == ARGB_OK);
+    CHECK(ARGB_Init_Ex(desk) == ARGB_OK);
+#if ARGB_USE_HW_LATCH
+    ARGB_Sim_SetTimIRQ(TIM3, desk_tim_irq);
+#endif
+    for (u16_t i = 0; i < NUM_PIXELS; i++) {
+        const u8_t r = (u8_t) (i * 23 + 5), g = (u8_t) (i * 3), b = (u8_t) (255 - i);
+        ARGB_SetRGB_Ex(desk, i, r, g, b);
+        exp[i * 3 + ARGB_LED_WS2812.order[0]] = r;
+        exp[i * 3 + ARGB_LED_WS2812.order[1]] = g;
+        exp[i * 3 + ARGB_LED_WS2812.order[2]] = b;
+    }
+    CHECK(ARGB_Show_Ex(desk) == ARGB_OK);
+    ARGB_Sim_RunDMA(&desk_hdma);
+    CHECK(ARGB_Ready_Ex(desk) == ARGB_READY);
+    CHECK(ARGB_Sim_Decode(&desk_hdma, desk->pwm_lo, desk->pwm_hi, out, sizeof(out)) == sizeof(out));
+    CHECK(memcmp(out, exp, sizeof(out)) == 0);
+    CHECK(ARGB_Sim_TrailingZeros(&desk_hdma) >= ARGB_RST_SLOTS);
+    CHECK(ARGB_Sim_Starts(&hdma_tim2_ch2_ch4) == starts); // The default strip stayed idle
+}
+
+#if !ARGB_USE_STREAMING
+/// A frame is one DMA transfer, NDTR is 16 bits
+static void test_xfer_limit(void) {
+    ARGB_Arena arena;
+    test_begin("xfer_limit");
+    CHECK(ARGB_Attach_Ex(&longest, &htim2, TIM_CHANNEL_2, &hdma_tim2_ch2_ch4, 2 * ARGB_SIM_PCLK1) == ARGB_OK);
+    CHECK(ARGB_Attach_Ex(&too_long, &htim2, TIM_CHANNEL_2, &hdma_tim2_ch2_ch4, 2 * ARGB_SIM_PCLK1) == ARGB_PARAM_ERR);
+    ARGB_ArenaInit(&arena, long_mem, sizeof(long_mem));
+    CHECK(ARGB_ArenaStripBytes(TEST_MAX_PIXELS + 1, NULL, 1) <= arena.size); // Fits the arena...
+    CHECK(ARGB_ArenaStrip(&arena, TEST_MAX_PIXELS + 1, NULL, 1) == NULL);   // ...not the DMA
+    CHECK(ARGB_ArenaStrip(&arena, TEST_MAX_PIXELS, NULL, 1) != NULL);
+}
+#endif
+
+static void test_burst(void) {
+    u8_t exp[TEST_LANES][TEST_BYTES], out[TEST_BYTES];
+    test_begin("burst");
+    memset(exp, 0, sizeof(exp));
+    for (u8_t c = 0; c < TEST_LANES; c++)
+        for (u16_t i = 0; i < NUM_PIXELS; i++) {
+            const u8_t r = (u8_t) (i * 37 + c), g = (u8_t) (i * 11), b = (u8_t) (c * 50 + 1);
+            ARGB_BurstSetRGB(&quad, c, i, r, g, b);
+            test_pack(exp[c], i, r, g, b);
+        }
+    CHECK(ARGB_BurstShow(&quad) == ARGB_OK);
+    ARGB_Sim_RunDMA(&quad_hdma);
+    CHECK(ARGB_BurstReady(&quad) == ARGB_READY);
+    for (u8_t c = 0; c < TEST_LANES; c++) {
+        CHECK(ARGB_Sim_DecodeStride(&quad_hdma, c, TEST_LANES, quad.pwm_lo,
+                                    quad.pwm_hi, out, TEST_BYTES) == TEST_BYTES);
+        CHECK(memcmp(out, exp[c], TEST_BYTES) == 0);
+    }
+}
+
+/// A DMA error drops the frame, stops the timer and frees the group for the next one
+static void test_burst_error(void) {
+    test_begin("burst_error");
+    CHECK(ARGB_BurstShow(&quad) == ARGB_OK);
+    quad_hdma.State = HAL_DMA_STATE_READY; // HAL_DMA_IRQHandler() on TEIF
+    quad_hdma.XferErrorCallback(&quad_hdma);
+    CHECK(ARGB_BurstErrors(&quad) == 1);
+    CHECK(ARGB_BurstReady(&quad) == ARGB_READY);
+    CHECK((quad_htim.Instance->CR1 & TIM_CR1_CEN) == 0);
+    CHECK((quad_htim.Instance->DIER & TIM_DMA_UPDATE) == 0);
+    CHECK(ARGB_BurstShow(&quad) == ARGB_OK);
+    ARGB_Sim_RunDMA(&quad_hdma);
+    CHECK(ARGB_BurstReady(&quad) == ARGB_READY);
+    CHECK(ARGB_BurstErrors(&quad) == 1);
+}
+
+static void test_burst_limit(void) {
+    test_begin("burst_limit");
+    CHECK(ARGB_BurstAttach(&quad_max, &quad_htim, &quad_hdma, 2 * ARGB_SIM_PCLK1) == ARGB_OK);
+    CHECK(ARGB_BurstAttach(&quad_over, &quad_htim, &quad_hdma, 2 * ARGB_SIM_PCLK1) == ARGB_PARAM_ERR);
+}
+
+static void test_par_limit(void) {
+    test_begin("par_limit");
+    CHECK(ARGB_ParAttach(&wall_max, &wall_htim, &wall_hdma, GPIOB, 0, 2 * ARGB_SIM_PCLK2) == ARGB_OK);
+    CHECK(ARGB_ParAttach(&wall_over, &wall_htim, &wall_hdma, GPIOB, 0, 2 * ARGB_SIM_PCLK2) == ARGB_PARAM_ERR);
+}
+
+static void test_parallel(void) {
+    u8_t exp[TEST_LANES][TEST_BYTES], out[TEST_BYTES];
+    test_begin("parallel");
+    memset(exp, 0, sizeof(exp));
+    for (u8_t l = 0; l < TEST_LANES; l++)
+        for (u16_t i = 0; i < NUM_PIXELS; i++) {
+            const u8_t r = (u8_t) (i * 29 + l), g = (u8_t) (l * 60), b = (u8_t) (i * 7 + 5);
+            ARGB_ParSetRGB(&wall, l, i, r, g, b);
+            test_pack(exp[l], i, r, g, b);
+        }
+    CHECK(ARGB_ParShow(&wall) == ARGB_OK);
+    ARGB_Sim_RunDMA(&wall_hdma);
+    CHECK(ARGB_ParReady(&wall) == ARGB_READY);
+    for (u8_t l = 0; l < TEST_LANES; l++) {
+        CHECK(ARGB_Sim_DecodeBSRR(&wall_hdma, (u8_t) (wall.first_pin + l), out, TEST_BYTES) == TEST_BYTES);
+        CHECK(memcmp(out, exp[l], TEST_BYTES) == 0);
+    }
+}
+
+int main(void) {
+    ARGB_Sim_Reset();
+#if ARGB_USE_STREAMING
+    hdma_tim2_ch2_ch4.Init.Mode = DMA_CIRCULAR;
+#endif
+    CHECK(ARGB_Attach(&htim2, TIM_CHANNEL_2, &hdma_tim2_ch2_ch4, 2 * ARGB_SIM_PCLK1) == ARGB_OK);
+    test_set(0, 0x11, 0x22, 0x33); // Before ARGB_Init(), see test_early()
+    ARGB_ParSetRGB(&wall, 0, 0, 0x44, 0x55, 0x66);
+    ARGB_BurstSetRGB(&quad, 0, 0, 0x77, 0x88, 0x99);
+    ARGB_Init();
+#if ARGB_USE_HW_LATCH
+    ARGB_Sim_SetTimIRQ(TIM2, ARGB_TIM_IRQHandler);
+#endif
+    ARGB_OnComplete(test_on_done, NULL);
+
+    wall_htim.Instance = TIM1;
+    wall_hdma.Init.MemDataAlignment = DMA_MDATAALIGN_WORD;
+    HAL_DMA_Init(&wall_hdma);
+    CHECK(ARGB_ParAttach(&wall, &wall_htim, &wall_hdma, GPIOB, 3, 2 * ARGB_SIM_PCLK2) == ARGB_OK);
+    CHECK(ARGB_ParInit(&wall) == ARGB_OK);
+
+    quad_htim.Instance = TIM4;
+    quad_hdma.Init.MemDataAlignment = hdma_tim2_ch2_ch4.Init.MemDataAlignment; // ARGB_PWM_WIDTH
+    HAL_DMA_Init(&quad_hdma);
+    CHECK(ARGB_BurstAttach(&quad, &quad_htim, &quad_hdma, 2 * ARGB_SIM_PCLK1) == ARGB_OK);
+    CHECK(ARGB_BurstInit(&quad) == ARGB_OK);
+
+    test_early();
+    test_full();
+    test_brightness();
+#if ARGB_USE_DITHER
+    test_dither();
+#endif
+    test_rainbow();
+    test_write_pixels();
+    test_swap_buffer();
+    test_pacer();
+    test_prefix();
+#if ARGB_USE_QUEUE
+    test_queue();
+#endif
+#if ARGB_QUEUE_COPY
+    test_snapshot();
+#endif
+#if ARGB_USE_STATS
+    test_stats();
+#endif
+#if ARGB_USE_TRACE
+    test_trace();
+#endif
+    test_led_type();
+    test_arena();
+#if !ARGB_USE_STREAMING
+    test_xfer_limit();
+#endif
+    test_burst();
+    test_burst_error();
+    test_burst_limit();
+    test_parallel();
+    test_par_limit();
+
+    printf("%s: %u failed\n", failures ? "FAIL" : "ok", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,133 @@
+/**
+ *******************************************
+ * @file    ARGB_StaticTest.cpp
+ * @brief   Host build of the C++ front ends: ARGB_Static.h and ARGB_RTOS.h
+ *******************************************
+ *
+ * @note The pin/DMA tables are checked while compiling (static_assert), a
+ *       strip on PB4 is brought up with Begin() and its frame decoded from the
+ *       simulated DMA, the FreeRTOS glue runs against the stand-in semphr.h /
+ *       task.h. -DTEST_NO_DMA_PIN must fail to compile (TIM4_CH4), run.sh
+ *       checks that too.
+ * @note Usage: static_test, exit code 0 if every check passed
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "main.h"
+#include "ARGB_Static.h"
+#include "ARGB_RTOS.h"
+
+using ARGB::pin;
+
+// ---- Tables, resolved while compiling ----
+
+using StripPA0 = ARGB::Strip<pin('A', 0), 60>;
+static_assert(StripPA0::timer == 2 && StripPA0::channel == 1 && StripPA0::af == 1, "PA0: TIM2_CH1, AF1");
+static_assert(StripPA0::dma == 1 && StripPA0::stream == 5 && StripPA0::request == 3, "TIM2_CH1: DMA1 Stream5 ch3");
+static_assert(StripPA0::pwm_width == 4, "TIM2 is 32-bit: WORD slots");
+
+using StripPA0Alt = ARGB::Strip<pin('A', 0, 1), 60>;
+static_assert(StripPA0Alt::timer == 5 && StripPA0Alt::channel == 1, "PA0 alt: TIM5_CH1");
+static_assert(StripPA0Alt::dma == 1 && StripPA0Alt::stream == 2 && StripPA0Alt::request == 6, "TIM5_CH1: DMA1 Stream2 ch6");
+
+using StripPA8 = ARGB::Strip<pin('A', 8), 60>;
+static_assert(StripPA8::timer == 1 && StripPA8::channel == 1 && StripPA8::af == 1, "PA8: TIM1_CH1, AF1");
+static_assert(StripPA8::dma == 2 && StripPA8::stream == 1 && StripPA8::request == 6, "TIM1_CH1: DMA2 Stream1 ch6");
+static_assert(StripPA8::pwm_width == 2, "TIM1 is 16-bit: HALFWORD slots");
+
+using StripPB8 = ARGB::Strip<pin('B', 8), 60>;
+static_assert(StripPB8::timer == 4 && StripPB8::channel == 3 && StripPB8::af == 2, "PB8: TIM4_CH3, AF2");
+static_assert(StripPB8::dma == 1 && StripPB8::stream == 7 && StripPB8::request == 2, "TIM4_CH3: DMA1 Stream7 ch2");
+
+#if !ARGB_USE_STREAMING
+static_assert(StripPA0::pwm_slots == 60UL * ARGB_BYTES_PER_PIXEL * 8 + ARGB_RST_SLOTS, "Frame + reset slots");
+#endif
+
+#ifdef TEST_NO_DMA_PIN
+ARGB::Strip<pin('B', 9), 60> no_dma; // TIM4_CH4 has no DMA request
+#endif
+
+// ---- Runtime ----
+
+#define TEST_BYTES (NUM_PIXELS * ARGB_BYTES_PER_PIXEL)
+
+static ARGB::Strip<pin('B', 4), NUM_PIXELS> desk; ///< TIM3_CH1, DMA1 Stream4
+static unsigned failures;
+
+#define CHECK(cond) test_check((cond), #cond, __LINE__)
+
+static void test_check(bool ok, const char *what, int line) {
+    if (ok) return;
+    printf("FAIL %s:%d: %s\n", __FILE__, line, what);
+    failures++;
+}
+
+#if ARGB_USE_HW_LATCH
+static void desk_tim_irq(void) { desk.TIM_IRQHandler(); }
+#endif
+
+/// Begin() binds the table entries, a frame goes out as set
+static void test_begin_show(void) {
+    ARGB_Strip *strip = desk.Handle();
+    u8_t exp[TEST_BYTES] = {}, out[TEST_BYTES];
+    printf("test static_show\n");
+    CHECK(desk.Begin() == ARGB_OK);
+#if ARGB_USE_HW_LATCH
+    ARGB_Sim_SetTimIRQ(TIM3, desk_tim_irq);
+#endif
+    CHECK(strip->htim->Instance == TIM3);
+    CHECK(strip->tim_channel == TIM_CHANNEL_1);
+    CHECK(strip->pwm_width == 2);
+    CHECK(desk.Size() == NUM_PIXELS);
+    for (u16_t i = 0; i < NUM_PIXELS; i++) {
+        const u8_t r = (u8_t) (i * 37 + 1), g = (u8_t) (i * 11 + 2), b = (u8_t) (i * 5 + 3);
+        desk.SetRGB(i, r, g, b);
+        exp[i * ARGB_BYTES_PER_PIXEL + ARGB_LED_DEFAULT.order[0]] = r;
+        exp[i * ARGB_BYTES_PER_PIXEL + ARGB_LED_DEFAULT.order[1]] = g;
+        exp[i * ARGB_BYTES_PER_PIXEL + ARGB_LED_DEFAULT.order[2]] = b;
+    }
+    CHECK(desk.Show() == ARGB_OK);
+    ARGB_Sim_RunDMA(strip->hdma);
+    CHECK(desk.Ready() == ARGB_READY);
+    CHECK(ARGB_Sim_Decode(strip->hdma, strip->pwm_lo, strip->pwm_hi, out, TEST_BYTES) == TEST_BYTES);
+    CHECK(memcmp(out, exp, TEST_BYTES) == 0);
+}
+
+/// Semaphore given from the completion ISR, WaitReady() blocks until then
+static void test_rtos_semaphore(void) {
+    ARGB_Strip *strip = desk.Handle();
+    static ARGB_SimSemaphore sem;
+    printf("test rtos_semaphore\n");
+    desk.OnComplete(ARGB_RTOS_GiveSemaphore, &sem);
+    desk.SetRGB(0, 1, 2, 3);
+    CHECK(desk.Show() == ARGB_OK);
+    CHECK(ARGB_RTOS_WaitReady(strip, &sem, 0) == pdFALSE); // On the wire, not given yet
+    ARGB_Sim_RunDMA(strip->hdma);
+    CHECK(sem.gives == 1);
+    CHECK(ARGB_RTOS_WaitReady(strip, &sem, portMAX_DELAY) == pdTRUE);
+}
+
+/// Task notified once per frame
+static void test_rtos_notify(void) {
+    ARGB_Strip *strip = desk.Handle();
+    static ARGB_SimTask task;
+    printf("test rtos_notify\n");
+    desk.OnComplete(ARGB_RTOS_NotifyTask, &task);
+    for (u8_t k = 0; k < 2; k++) {
+        desk.SetRGB(0, k, k, k);
+        CHECK(desk.Show() == ARGB_OK);
+        ARGB_Sim_RunDMA(strip->hdma);
+    }
+    CHECK(task.notified == 2);
+}
+
+int main(void) {
+    ARGB_Sim_Reset();
+    test_begin_show();
+    test_rtos_semaphore();
+    test_rtos_notify();
+
+    printf("%s: %u failed\n", failures ? "FAIL" : "ok", failures);
+    return failures ? 1 : 0;
+}
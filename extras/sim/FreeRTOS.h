@@ -0,0 +1,33 @@
+/**
+ *******************************************
+ * @file    FreeRTOS.h
+ * @brief   Host-side stand-in for the FreeRTOS kernel header
+ *******************************************
+ *
+ * @note Only the subset used by ARGB_RTOS.h is modelled: no scheduler, a
+ *       blocking call that would wait returns at once as if it timed out.
+ *       semphr.h and task.h hold the objects.
+ */
+
+#ifndef ARGB_SIM_FREERTOS_H_
+#define ARGB_SIM_FREERTOS_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef long BaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE ((BaseType_t) 0)
+#define pdTRUE  ((BaseType_t) 1)
+#define portMAX_DELAY ((TickType_t) 0xFFFFFFFFUL)
+#define portYIELD_FROM_ISR(x) ((void) (x))
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ARGB_SIM_FREERTOS_H_ */
@@ -0,0 +1,119 @@
+/**
+ *******************************************
+ * @file    PeripheralPins.h
+ * @brief   Host-side stand-in for the STM32duino pin names and PWM pin map
+ *******************************************
+ *
+ * @note PinMap_PWM is the STM32F401/F411 variant table cut down to the
+ *       ports and timers the simulation has (GPIOA..C, TIM1..5), in the
+ *       core's order: every pin, then its _ALT1 entries. Arduino pin numbers
+ *       are the pin names themselves (PA0 == PA_0).
+ */
+
+#ifndef ARGB_SIM_PERIPHERALPINS_H_
+#define ARGB_SIM_PERIPHERALPINS_H_
+
+#include "main.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// ---- Pin names: port << 4 | pin, ALTx selects another peripheral of the pin ----
+#define ALT1      0x100
+#define ALTX_MASK 0x700
+
+typedef enum {
+    PA_0 = 0x00, PA_1 = 0x01, PA_2 = 0x02, PA_3 = 0x03,
+    PA_5 = 0x05, PA_6 = 0x06, PA_7 = 0x07, PA_8 = 0x08,
+    PA_9 = 0x09, PA_10 = 0x0A, PA_11 = 0x0B,
+    PB_0 = 0x10, PB_4 = 0x14, PB_5 = 0x15, PB_6 = 0x16,
+    PB_7 = 0x17, PB_8 = 0x18, PB_9 = 0x19, PB_13 = 0x1D,
+    PC_6 = 0x26, PC_13 = 0x2D,
+    PA_0_ALT1 = PA_0 | ALT1, PA_1_ALT1 = PA_1 | ALT1,
+    PA_2_ALT1 = PA_2 | ALT1, PA_3_ALT1 = PA_3 | ALT1,
+    PA_7_ALT1 = PA_7 | ALT1, PB_0_ALT1 = PB_0 | ALT1,
+    NC = (int) 0xFFFFFFFF
+} PinName;
+
+#define PA0  PA_0
+#define PA1  PA_1
+#define PA2  PA_2
+#define PA3  PA_3
+#define PA5  PA_5
+#define PA6  PA_6
+#define PA7  PA_7
+#define PA8  PA_8
+#define PA9  PA_9
+#define PA10 PA_10
+#define PA11 PA_11
+#define PB0  PB_0
+#define PB4  PB_4
+#define PB5  PB_5
+#define PB6  PB_6
+#define PB7  PB_7
+#define PB8  PB_8
+#define PB9  PB_9
+#define PB13 PB_13
+#define PC6  PC_6
+#define PC13 PC_13
+
+#define STM_PORT(X)     (((uint32_t) (X) >> 4) & 0xF)
+#define STM_PIN(X)      ((uint32_t) (X) & 0xF)
+#define STM_GPIO_PIN(X) ((uint16_t) (1U << STM_PIN(X)))
+
+static inline PinName digitalPinToPinName(uint32_t p) {
+    return p < 0x30 ? (PinName) p : NC; // GPIOA..C only
+}
+
+static inline GPIO_TypeDef *get_GPIO_Port(uint32_t port) {
+    return port < 3 ? &ARGB_Sim_GPIO[port] : NULL;
+}
+
+// ---- Pin functions: AF number, timer channel, complementary output ----
+#define STM_PIN_DATA_EXT(AFNUM, CHAN, INV) ((AFNUM) | ((CHAN) << 8) | ((INV) << 16))
+#define STM_PIN_AFNUM(X)    ((X) & 0xFF)
+#define STM_PIN_CHANNEL(X)  (((X) >> 8) & 0x1F)
+#define STM_PIN_INVERTED(X) (((X) >> 16) & 0x1)
+
+typedef struct {
+    PinName pin;
+    void *peripheral;
+    int function;
+} PinMap;
+
+static const PinMap PinMap_PWM[] = {
+    {PA_0,      TIM2, STM_PIN_DATA_EXT(1, 1, 0)},
+    {PA_0_ALT1, TIM5, STM_PIN_DATA_EXT(2, 1, 0)},
+    {PA_1,      TIM2, STM_PIN_DATA_EXT(1, 2, 0)},
+    {PA_1_ALT1, TIM5, STM_PIN_DATA_EXT(2, 2, 0)},
+    {PA_2,      TIM2, STM_PIN_DATA_EXT(1, 3, 0)},
+    {PA_2_ALT1, TIM5, STM_PIN_DATA_EXT(2, 3, 0)},
+    {PA_3,      TIM2, STM_PIN_DATA_EXT(1, 4, 0)},
+    {PA_3_ALT1, TIM5, STM_PIN_DATA_EXT(2, 4, 0)},
+    {PA_5,      TIM2, STM_PIN_DATA_EXT(1, 1, 0)},
+    {PA_6,      TIM3, STM_PIN_DATA_EXT(2, 1, 0)},
+    {PA_7,      TIM1, STM_PIN_DATA_EXT(1, 1, 1)}, // TIM1_CH1N
+    {PA_7_ALT1, TIM3, STM_PIN_DATA_EXT(2, 2, 0)},
+    {PA_8,      TIM1, STM_PIN_DATA_EXT(1, 1, 0)},
+    {PA_9,      TIM1, STM_PIN_DATA_EXT(1, 2, 0)},
+    {PA_10,     TIM1, STM_PIN_DATA_EXT(1, 3, 0)},
+    {PA_11,     TIM1, STM_PIN_DATA_EXT(1, 4, 0)},
+    {PB_0,      TIM1, STM_PIN_DATA_EXT(1, 2, 1)}, // TIM1_CH2N
+    {PB_0_ALT1, TIM3, STM_PIN_DATA_EXT(2, 3, 0)},
+    {PB_4,      TIM3, STM_PIN_DATA_EXT(2, 1, 0)},
+    {PB_5,      TIM3, STM_PIN_DATA_EXT(2, 2, 0)},
+    {PB_6,      TIM4, STM_PIN_DATA_EXT(2, 1, 0)},
+    {PB_7,      TIM4, STM_PIN_DATA_EXT(2, 2, 0)},
+    {PB_8,      TIM4, STM_PIN_DATA_EXT(2, 3, 0)},
+    {PB_9,      TIM4, STM_PIN_DATA_EXT(2, 4, 0)}, // No DMA request on F4
+    {PB_13,     TIM1, STM_PIN_DATA_EXT(1, 1, 1)}, // TIM1_CH1N
+    {PC_6,      TIM3, STM_PIN_DATA_EXT(2, 1, 0)},
+    {NC,        NULL, 0}
+};
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ARGB_SIM_PERIPHERALPINS_H_ */
@@ -0,0 +1,14 @@
+/**
+ *******************************************
+ * @file    PinAF_STM32F1.h
+ * @brief   Host-side stand-in for the STM32duino F1 pin remap header
+ *******************************************
+ *
+ * @note The simulation is an F4 part: pin functions are plain AF numbers in
+ *       PinMap_PWM (PeripheralPins.h), there is no remap to model.
+ */
+
+#ifndef ARGB_SIM_PINAF_STM32F1_H_
+#define ARGB_SIM_PINAF_STM32F1_H_
+
+#endif /* ARGB_SIM_PINAF_STM32F1_H_ */
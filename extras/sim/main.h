@@ -0,0 +1,268 @@
+/**
+ *******************************************
+ * @file    main.h
+ * @brief   Host-side stand-in for CubeMX main.h / STM32 HAL
+ *******************************************
+ *
+ * @note Only the subset of HAL used by the ARGB driver is modelled.
+ *       Registers are plain memory, DMA transfers are executed by
+ *       ARGB_Sim_RunDMA() (see ARGB_Sim.h).
+ *
+ * @note Build: cc -Iextras/sim -Isrc src/ARGB.c extras/sim/ARGB_Sim.c your_test.c
+ */
+
+#ifndef ARGB_SIM_MAIN_H_
+#define ARGB_SIM_MAIN_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ARGB_SIM 1  ///< Host simulation build
+
+#define __IO volatile
+
+typedef enum {
+    HAL_OK = 0x00U,
+    HAL_ERROR = 0x01U,
+    HAL_BUSY = 0x02U,
+    HAL_TIMEOUT = 0x03U
+} HAL_StatusTypeDef;
+
+typedef enum {
+    RESET = 0U,
+    SET = !RESET
+} FlagStatus, ITStatus;
+
+// ---- CMSIS core ----
+extern uint32_t ARGB_Sim_PRIMASK; ///< 1 - interrupts masked
+
+static inline uint32_t __get_PRIMASK(void) { return ARGB_Sim_PRIMASK; }
+static inline void __set_PRIMASK(uint32_t priMask) { ARGB_Sim_PRIMASK = priMask; }
+static inline void __disable_irq(void) { ARGB_Sim_PRIMASK = 1; }
+static inline void __enable_irq(void) { ARGB_Sim_PRIMASK = 0; }
+
+typedef struct {
+    __IO uint32_t CTRL;
+    __IO uint32_t CYCCNT;  ///< Advanced by ARGB_Sim_RunDMA() only
+} DWT_Type;
+
+typedef struct {
+    __IO uint32_t DEMCR;
+} CoreDebug_Type;
+
+#define DWT_CTRL_CYCCNTENA_Msk      (1UL << 0)
+#define CoreDebug_DEMCR_TRCENA_Msk  (1UL << 24)
+
+extern DWT_Type ARGB_Sim_DWT;
+extern CoreDebug_Type ARGB_Sim_CoreDebug;
+#define DWT (&ARGB_Sim_DWT)
+#define CoreDebug (&ARGB_Sim_CoreDebug)
+
+// ---- RCC ----
+typedef struct {
+    __IO uint32_t CFGR;
+} RCC_TypeDef;
+
+#define RCC_CFGR_PPRE1 (0x7UL << 10U)
+#define RCC_CFGR_PPRE2 (0x7UL << 13U)
+
+extern RCC_TypeDef ARGB_Sim_RCC;
+#define RCC (&ARGB_Sim_RCC)
+
+uint32_t HAL_RCC_GetPCLK1Freq(void);
+uint32_t HAL_RCC_GetPCLK2Freq(void);
+void HAL_Delay(uint32_t Delay);
+uint32_t HAL_GetTick(void);
+extern uint32_t ARGB_Sim_Tick; ///< HAL_GetTick() value, ms; HAL_Delay() advances it
+
+// ---- GPIO ----
+typedef struct {
+    __IO uint32_t MODER;
+    __IO uint32_t OTYPER;
+    __IO uint32_t OSPEEDR;
+    __IO uint32_t PUPDR;
+    __IO uint32_t IDR;
+    __IO uint32_t ODR;
+    __IO uint32_t BSRR;
+    __IO uint32_t LCKR;
+    __IO uint32_t AFR[2];
+} GPIO_TypeDef;
+
+extern GPIO_TypeDef ARGB_Sim_GPIO[3];
+#define GPIOA (&ARGB_Sim_GPIO[0])
+#define GPIOB (&ARGB_Sim_GPIO[1])
+#define GPIOC (&ARGB_Sim_GPIO[2])
+
+// ---- TIM ----
+typedef struct ARGB_SimTIM {
+    __IO uint32_t CR1;
+    __IO uint32_t CR2;
+    __IO uint32_t SMCR;
+    __IO uint32_t DIER;
+    __IO uint32_t SR;
+    __IO uint32_t EGR;
+    __IO uint32_t CCMR1;
+    __IO uint32_t CCMR2;
+    __IO uint32_t CCER;
+    __IO uint32_t CNT;
+    __IO uint32_t PSC;
+    __IO uint32_t ARR;
+    __IO uint32_t RCR;
+    __IO uint32_t CCR1;
+    __IO uint32_t CCR2;
+    __IO uint32_t CCR3;
+    __IO uint32_t CCR4;
+    __IO uint32_t BDTR;
+    __IO uint32_t DCR;
+    __IO uint32_t DMAR;
+} TIM_TypeDef;
+
+extern TIM_TypeDef ARGB_Sim_TIM[9];  ///< Index = timer number
+#define TIM1 (&ARGB_Sim_TIM[1])
+#define TIM2 (&ARGB_Sim_TIM[2])
+#define TIM3 (&ARGB_Sim_TIM[3])
+#define TIM4 (&ARGB_Sim_TIM[4])
+#define TIM5 (&ARGB_Sim_TIM[5])
+#define TIM8 (&ARGB_Sim_TIM[8])
+
+#define TIM_CHANNEL_1 0x00000000U
+#define TIM_CHANNEL_2 0x00000004U
+#define TIM_CHANNEL_3 0x00000008U
+#define TIM_CHANNEL_4 0x0000000CU
+
+#define TIM_CR1_CEN      (1UL << 0)
+#define TIM_BDTR_MOE     (1UL << 15)
+#define TIM_DIER_UIE     (1UL << 0)
+#define TIM_DIER_UDE     (1UL << 8)
+#define TIM_DIER_CC1DE   (1UL << 9)
+#define TIM_DIER_CC2DE   (1UL << 10)
+#define TIM_DIER_CC3DE   (1UL << 11)
+#define TIM_DIER_CC4DE   (1UL << 12)
+
+#define TIM_EGR_UG       (1UL << 0)
+
+#define TIM_IT_UPDATE  TIM_DIER_UIE
+
+#define TIM_DMA_UPDATE TIM_DIER_UDE
+#define TIM_DMA_CC1    TIM_DIER_CC1DE
+#define TIM_DMA_CC2    TIM_DIER_CC2DE
+#define TIM_DMA_CC3    TIM_DIER_CC3DE
+#define TIM_DMA_CC4    TIM_DIER_CC4DE
+
+#define TIM_DMA_ID_UPDATE 0U
+#define TIM_DMA_ID_CC1    1U
+#define TIM_DMA_ID_CC2    2U
+#define TIM_DMA_ID_CC3    3U
+#define TIM_DMA_ID_CC4    4U
+
+#define TIM_FLAG_UPDATE (1UL << 0)
+#define TIM_FLAG_CC1    (1UL << 1)
+#define TIM_FLAG_CC2    (1UL << 2)
+#define TIM_FLAG_CC3    (1UL << 3)
+#define TIM_FLAG_CC4    (1UL << 4)
+
+#define TIM_DMABASE_CCR1 0x0000000DU  ///< DCR.DBA: CCR1 word offset
+#define TIM_DCR_DBL_Pos  8U           ///< DCR.DBL: burst length - 1
+
+#define TIM_CCx_ENABLE  1U
+#define TIM_CCx_DISABLE 0U
+
+typedef enum {
+    HAL_TIM_ACTIVE_CHANNEL_CLEARED = 0x00U
+} HAL_TIM_ActiveChannel;
+
+typedef enum {
+    HAL_TIM_CHANNEL_STATE_RESET = 0x00U,
+    HAL_TIM_CHANNEL_STATE_READY = 0x01U,
+    HAL_TIM_CHANNEL_STATE_BUSY = 0x02U
+} HAL_TIM_ChannelStateTypeDef;
+
+struct __DMA_HandleTypeDef;
+
+typedef struct {
+    TIM_TypeDef *Instance;
+    HAL_TIM_ActiveChannel Channel;
+    struct __DMA_HandleTypeDef *hdma[7];
+    __IO HAL_TIM_ChannelStateTypeDef ChannelState[4];
+} TIM_HandleTypeDef;
+
+#define IS_TIM_BREAK_INSTANCE(INSTANCE) (((INSTANCE) == TIM1) || ((INSTANCE) == TIM8))
+
+#define TIM_CHANNEL_STATE_SET(__HANDLE__, __CHANNEL__, __CHANNEL_STATE__) \
+    ((__HANDLE__)->ChannelState[(__CHANNEL__) >> 2U] = (__CHANNEL_STATE__))
+
+#define __HAL_TIM_ENABLE(__HANDLE__)      ((__HANDLE__)->Instance->CR1 |= TIM_CR1_CEN)
+#define __HAL_TIM_DISABLE(__HANDLE__)     ((__HANDLE__)->Instance->CR1 &= ~TIM_CR1_CEN)
+#define __HAL_TIM_MOE_ENABLE(__HANDLE__)  ((__HANDLE__)->Instance->BDTR |= TIM_BDTR_MOE)
+#define __HAL_TIM_MOE_DISABLE(__HANDLE__) ((__HANDLE__)->Instance->BDTR &= ~TIM_BDTR_MOE)
+#define __HAL_TIM_ENABLE_DMA(__HANDLE__, __DMA__)  ((__HANDLE__)->Instance->DIER |= (__DMA__))
+#define __HAL_TIM_DISABLE_DMA(__HANDLE__, __DMA__) ((__HANDLE__)->Instance->DIER &= ~(__DMA__))
+#define __HAL_TIM_ENABLE_IT(__HANDLE__, __IT__)   ((__HANDLE__)->Instance->DIER |= (__IT__))
+#define __HAL_TIM_DISABLE_IT(__HANDLE__, __IT__)  ((__HANDLE__)->Instance->DIER &= ~(__IT__))
+#define __HAL_TIM_CLEAR_FLAG(__HANDLE__, __FLAG__) ((__HANDLE__)->Instance->SR = ~(uint32_t) (__FLAG__))
+
+void TIM_CCxChannelCmd(TIM_TypeDef *TIMx, uint32_t Channel, uint32_t ChannelState);
+
+// ---- DMA ----
+#define DMA_PDATAALIGN_BYTE     0x00000000U
+#define DMA_PDATAALIGN_HALFWORD (1UL << 11)
+#define DMA_PDATAALIGN_WORD     (2UL << 11)
+#define DMA_MDATAALIGN_BYTE     0x00000000U
+#define DMA_MDATAALIGN_HALFWORD (1UL << 13)
+#define DMA_MDATAALIGN_WORD     (2UL << 13)
+#define DMA_NORMAL              0x00000000U
+#define DMA_CIRCULAR            (1UL << 8)
+
+typedef enum {
+    HAL_DMA_STATE_RESET = 0x00U,
+    HAL_DMA_STATE_READY = 0x01U,
+    HAL_DMA_STATE_BUSY = 0x02U,
+    HAL_DMA_STATE_TIMEOUT = 0x03U,
+    HAL_DMA_STATE_ERROR = 0x04U,
+    HAL_DMA_STATE_ABORT = 0x05U
+} HAL_DMA_StateTypeDef;
+
+typedef struct {
+    uint32_t Channel;
+    uint32_t Direction;
+    uint32_t PeriphInc;
+    uint32_t MemInc;
+    uint32_t PeriphDataAlignment;
+    uint32_t MemDataAlignment;
+    uint32_t Mode;
+    uint32_t Priority;
+    uint32_t FIFOMode;
+} DMA_InitTypeDef;
+
+typedef struct __DMA_HandleTypeDef {
+    void *Instance;
+    DMA_InitTypeDef Init;
+    __IO HAL_DMA_StateTypeDef State;
+    void *Parent;
+    void (*XferCpltCallback)(struct __DMA_HandleTypeDef *hdma);
+    void (*XferHalfCpltCallback)(struct __DMA_HandleTypeDef *hdma);
+    void (*XferErrorCallback)(struct __DMA_HandleTypeDef *hdma);
+    __IO uint32_t ErrorCode;
+} DMA_HandleTypeDef;
+
+#define __HAL_LINKDMA(__HANDLE__, __PPP_DMA_FIELD__, __DMA_HANDLE__) \
+    do { (__HANDLE__)->__PPP_DMA_FIELD__ = &(__DMA_HANDLE__); \
+         (__DMA_HANDLE__).Parent = (__HANDLE__); } while (0)
+
+HAL_StatusTypeDef HAL_DMA_Init(DMA_HandleTypeDef *hdma);
+HAL_StatusTypeDef HAL_DMA_Start_IT(DMA_HandleTypeDef *hdma, uint32_t SrcAddress,
+                                   uint32_t DstAddress, uint32_t DataLength);
+HAL_StatusTypeDef HAL_DMA_Abort(DMA_HandleTypeDef *hdma);
+void TIM_DMAError(DMA_HandleTypeDef *hdma);
+
+#ifdef __cplusplus
+}
+#endif
+
+#include "ARGB_Sim.h"
+
+#endif /* ARGB_SIM_MAIN_H_ */
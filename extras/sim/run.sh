@@ -0,0 +1,122 @@
+#!/bin/sh
+# Build and run ARGB_SimTest.c for every configuration of the matrix, dithered
+# builds per family / streaming / queue / skip, RGB builds with RGBW-sized buffers
+# (switching to SK6812 at runtime) per streaming / latch, traced builds (with the
+# Chrome JSON export) per family / streaming / latch, the ARGB_Auto.h allocator
+# (ARGB_AutoTest.c) and the C++ front ends (ARGB_StaticTest.cpp) per family /
+# streaming / latch.
+# Usage: extras/sim/run.sh           -> exit code 0 if every configuration passed
+# Env:   CC (default cc), CXX (default c++), CFLAGS (default -O2 -Wall -Wextra),
+#        EXTRA (extra -D options)
+set -e
+
+ROOT=$(cd "$(dirname "$0")/../.." && pwd)
+CC=${CC:-cc}
+CXX=${CXX:-c++}
+CFLAGS=${CFLAGS:-"-O2 -Wall -Wextra"}
+OUT=$(mktemp -d)
+trap 'rm -rf "$OUT"' EXIT
+
+for family in WS2812 SK6812; do
+    for stream in 0 1; do
+        for latch in 0 1; do
+            for queue in 0 1; do
+                for skip in 0 1; do
+                    name="${family}_stream${stream}_latch${latch}_queue${queue}_skip${skip}"
+                    echo "== $name"
+                    $CC $CFLAGS -D$family -DNUM_PIXELS=16 -DARGB_USE_STREAMING=$stream \
+                        -DARGB_USE_HW_LATCH=$latch -DARGB_USE_QUEUE=$queue \
+                        -DARGB_SKIP_UNCHANGED=$skip $EXTRA \
+                        -I"$ROOT/extras/sim" -I"$ROOT/src" \
+                        "$ROOT/src/ARGB.c" "$ROOT/extras/sim/ARGB_Sim.c" "$ROOT/extras/sim/ARGB_SimTest.c" \
+                        -o "$OUT/sim_test_$name" -lm
+                    "$OUT/sim_test_$name"
+                done
+            done
+        done
+    done
+done
+
+for family in WS2812 SK6812; do
+    for stream in 0 1; do
+        for queue in 0 1; do
+            for skip in 0 1; do
+                name="${family}_stream${stream}_queue${queue}_skip${skip}_dither"
+                echo "== $name"
+                $CC $CFLAGS -D$family -DNUM_PIXELS=16 -DARGB_USE_STREAMING=$stream \
+                    -DARGB_USE_QUEUE=$queue -DARGB_SKIP_UNCHANGED=$skip -DARGB_USE_DITHER=1 $EXTRA \
+                    -I"$ROOT/extras/sim" -I"$ROOT/src" \
+                    "$ROOT/src/ARGB.c" "$ROOT/extras/sim/ARGB_Sim.c" "$ROOT/extras/sim/ARGB_SimTest.c" \
+                    -o "$OUT/sim_test_$name" -lm
+                "$OUT/sim_test_$name"
+            done
+        done
+    done
+done
+
+for stream in 0 1; do
+    for latch in 0 1; do
+        name="WS2812_stream${stream}_latch${latch}_rgbw"
+        echo "== $name"
+        $CC $CFLAGS -DWS2812 -DNUM_PIXELS=16 -DARGB_USE_STREAMING=$stream \
+            -DARGB_USE_HW_LATCH=$latch -DARGB_MAX_BYTES_PER_PIXEL=4 $EXTRA \
+            -I"$ROOT/extras/sim" -I"$ROOT/src" \
+            "$ROOT/src/ARGB.c" "$ROOT/extras/sim/ARGB_Sim.c" "$ROOT/extras/sim/ARGB_SimTest.c" \
+            -o "$OUT/sim_test_$name" -lm
+        "$OUT/sim_test_$name"
+    done
+done
+
+for family in WS2812 SK6812; do
+    for stream in 0 1; do
+        for latch in 0 1; do
+            name="${family}_stream${stream}_latch${latch}_trace"
+            echo "== $name"
+            $CC $CFLAGS -D$family -DNUM_PIXELS=16 -DARGB_USE_STREAMING=$stream \
+                -DARGB_USE_HW_LATCH=$latch -DARGB_USE_QUEUE=1 -DARGB_USE_TRACE=1 $EXTRA \
+                -I"$ROOT/extras/sim" -I"$ROOT/src" -I"$ROOT/extras/trace" \
+                "$ROOT/src/ARGB.c" "$ROOT/extras/sim/ARGB_Sim.c" "$ROOT/extras/trace/ARGB_TraceJSON.c" \
+                "$ROOT/extras/sim/ARGB_SimTest.c" -o "$OUT/sim_test_$name" -lm
+            "$OUT/sim_test_$name"
+        done
+    done
+done
+
+for family in WS2812 SK6812; do
+    for stream in 0 1; do
+        for latch in 0 1; do
+            name="${family}_stream${stream}_latch${latch}_auto"
+            echo "== $name"
+            $CC $CFLAGS -D$family -DNUM_PIXELS=16 -DARGB_USE_STREAMING=$stream \
+                -DARGB_USE_HW_LATCH=$latch $EXTRA \
+                -I"$ROOT/extras/sim" -I"$ROOT/src" \
+                "$ROOT/src/ARGB.c" "$ROOT/extras/sim/ARGB_Sim.c" "$ROOT/extras/sim/ARGB_AutoTest.c" \
+                -o "$OUT/auto_test_$name" -lm
+            "$OUT/auto_test_$name"
+        done
+    done
+done
+
+for family in WS2812 SK6812; do
+    for stream in 0 1; do
+        for latch in 0 1; do
+            name="${family}_stream${stream}_latch${latch}_cxx"
+            echo "== $name"
+            DEFS="-D$family -DNUM_PIXELS=16 -DARGB_USE_STREAMING=$stream -DARGB_USE_HW_LATCH=$latch $EXTRA"
+            $CC $CFLAGS $DEFS -I"$ROOT/extras/sim" -I"$ROOT/src" -c "$ROOT/src/ARGB.c" -o "$OUT/argb.o"
+            $CC $CFLAGS $DEFS -I"$ROOT/extras/sim" -I"$ROOT/src" -c "$ROOT/extras/sim/ARGB_Sim.c" -o "$OUT/sim.o"
+            $CXX -std=c++14 $CFLAGS $DEFS -I"$ROOT/extras/sim" -I"$ROOT/src" \
+                "$ROOT/extras/sim/ARGB_StaticTest.cpp" "$OUT/argb.o" "$OUT/sim.o" \
+                -o "$OUT/static_test_$name" -lm
+            "$OUT/static_test_$name"
+        done
+    done
+done
+
+echo "== TIM4_CH4 strip must not compile"
+if $CXX -std=c++14 -fsyntax-only -DWS2812 -DNUM_PIXELS=16 -DTEST_NO_DMA_PIN $EXTRA \
+        -I"$ROOT/extras/sim" -I"$ROOT/src" "$ROOT/extras/sim/ARGB_StaticTest.cpp" 2>/dev/null; then
+    echo "FAIL: ARGB::Strip on a pin without DMA request compiled"
+    exit 1
+fi
+echo "all configurations passed"
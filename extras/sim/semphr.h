@@ -0,0 +1,43 @@
+/**
+ *******************************************
+ * @file    semphr.h
+ * @brief   Host-side stand-in for FreeRTOS binary semaphores
+ *******************************************
+ */
+
+#ifndef ARGB_SIM_SEMPHR_H_
+#define ARGB_SIM_SEMPHR_H_
+
+#include "FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Binary semaphore, define one and pass its address as the handle
+typedef struct {
+    volatile uint32_t given; ///< 1 - available to take
+    uint32_t gives;          ///< Successful gives so far
+} ARGB_SimSemaphore;
+typedef ARGB_SimSemaphore *SemaphoreHandle_t;
+
+static inline BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t sem, BaseType_t *woken) {
+    if (sem->given) return pdFALSE;
+    sem->given = 1;
+    sem->gives++;
+    if (woken) *woken = pdTRUE;
+    return pdTRUE;
+}
+
+static inline BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t timeout) {
+    (void) timeout; // No other task can give it while we wait
+    if (!sem->given) return pdFALSE;
+    sem->given = 0;
+    return pdTRUE;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ARGB_SIM_SEMPHR_H_ */
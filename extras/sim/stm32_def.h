@@ -0,0 +1,104 @@
+/**
+ *******************************************
+ * @file    stm32_def.h
+ * @brief   Host-side stand-in for the STM32duino core header, as used by ARGB_Auto.h
+ *******************************************
+ *
+ * @note The HAL comes from the stand-in main.h, this adds the STM32F4 DMA
+ *       streams, their IRQ numbers and request channels that ARGB_DMA_MAP
+ *       refers to. Streams are plain memory owned by the including file.
+ * @note DMA_SxCR_EN stays undefined: the driver core of the simulation is a
+ *       channel-DMA build (ARGB_PWM_WIDTH 1), ARGB_PwmWidth() agrees with it.
+ */
+
+#ifndef ARGB_SIM_STM32_DEF_H_
+#define ARGB_SIM_STM32_DEF_H_
+
+#include <string.h>
+#include "main.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define STM32F4xx 1 ///< Family of the DMA request table
+
+// ---- DMA ----
+typedef struct {
+    __IO uint32_t CR;
+    __IO uint32_t NDTR;
+    __IO uint32_t PAR;
+    __IO uint32_t M0AR;
+    __IO uint32_t M1AR;
+    __IO uint32_t FCR;
+} DMA_Stream_TypeDef;
+
+typedef struct {
+    __IO uint32_t LISR;
+    __IO uint32_t HISR;
+    __IO uint32_t LIFCR;
+    __IO uint32_t HIFCR;
+} DMA_TypeDef;
+
+static DMA_TypeDef ARGB_Sim_DMA[2];
+static DMA_Stream_TypeDef ARGB_Sim_DMA_Stream[16]; ///< DMA1 Stream0..7, DMA2 Stream0..7
+
+#define DMA1 (&ARGB_Sim_DMA[0])
+#define DMA2 (&ARGB_Sim_DMA[1])
+#define DMA1_Stream0 (&ARGB_Sim_DMA_Stream[0])
+#define DMA1_Stream1 (&ARGB_Sim_DMA_Stream[1])
+#define DMA1_Stream2 (&ARGB_Sim_DMA_Stream[2])
+#define DMA1_Stream3 (&ARGB_Sim_DMA_Stream[3])
+#define DMA1_Stream4 (&ARGB_Sim_DMA_Stream[4])
+#define DMA1_Stream5 (&ARGB_Sim_DMA_Stream[5])
+#define DMA1_Stream6 (&ARGB_Sim_DMA_Stream[6])
+#define DMA1_Stream7 (&ARGB_Sim_DMA_Stream[7])
+#define DMA2_Stream0 (&ARGB_Sim_DMA_Stream[8])
+#define DMA2_Stream1 (&ARGB_Sim_DMA_Stream[9])
+#define DMA2_Stream2 (&ARGB_Sim_DMA_Stream[10])
+#define DMA2_Stream3 (&ARGB_Sim_DMA_Stream[11])
+#define DMA2_Stream4 (&ARGB_Sim_DMA_Stream[12])
+#define DMA2_Stream5 (&ARGB_Sim_DMA_Stream[13])
+#define DMA2_Stream6 (&ARGB_Sim_DMA_Stream[14])
+#define DMA2_Stream7 (&ARGB_Sim_DMA_Stream[15])
+
+#define DMA_CHANNEL_0 0x00000000U
+#define DMA_CHANNEL_1 0x02000000U
+#define DMA_CHANNEL_2 0x04000000U
+#define DMA_CHANNEL_3 0x06000000U
+#define DMA_CHANNEL_4 0x08000000U
+#define DMA_CHANNEL_5 0x0A000000U
+#define DMA_CHANNEL_6 0x0C000000U
+#define DMA_CHANNEL_7 0x0E000000U
+
+#define DMA_MEMORY_TO_PERIPH (1UL << 6)
+#define DMA_PINC_DISABLE     0x00000000U
+#define DMA_MINC_ENABLE      (1UL << 10)
+#define DMA_PRIORITY_HIGH    (2UL << 16)
+#define DMA_FIFOMODE_DISABLE 0x00000000U
+
+// ---- NVIC ----
+typedef enum {
+    DMA1_Stream0_IRQn = 11,
+    DMA1_Stream1_IRQn = 12,
+    DMA1_Stream2_IRQn = 13,
+    DMA1_Stream3_IRQn = 14,
+    DMA1_Stream4_IRQn = 15,
+    DMA1_Stream5_IRQn = 16,
+    DMA1_Stream6_IRQn = 17,
+    DMA1_Stream7_IRQn = 47,
+    DMA2_Stream0_IRQn = 56,
+    DMA2_Stream1_IRQn = 57,
+    DMA2_Stream2_IRQn = 58,
+    DMA2_Stream3_IRQn = 59,
+    DMA2_Stream4_IRQn = 60,
+    DMA2_Stream5_IRQn = 68,
+    DMA2_Stream6_IRQn = 69,
+    DMA2_Stream7_IRQn = 70
+} IRQn_Type;
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ARGB_SIM_STM32_DEF_H_ */
@@ -0,0 +1,32 @@
+/**
+ *******************************************
+ * @file    task.h
+ * @brief   Host-side stand-in for FreeRTOS task notifications
+ *******************************************
+ */
+
+#ifndef ARGB_SIM_TASK_H_
+#define ARGB_SIM_TASK_H_
+
+#include "FreeRTOS.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/// Task, define one and pass its address as the handle
+typedef struct {
+    volatile uint32_t notified; ///< Notification value
+} ARGB_SimTask;
+typedef ARGB_SimTask *TaskHandle_t;
+
+static inline void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken) {
+    task->notified++;
+    if (woken) *woken = pdTRUE;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ARGB_SIM_TASK_H_ */
@@ -0,0 +1,65 @@
+/**
+ *******************************************
+ * @file    ARGB_TraceDemo.c
+ * @brief   Simulated paced animation recorded by the trace ring
+ *******************************************
+ *
+ * @note A strip is paced at DEMO_FPS with a render hook; every other frame the
+ *       application shows once more mid-period, so queued frames appear too.
+ *       Time is the simulation's virtual core clock (see ARGB_Sim.h).
+ * @note Usage: trace_demo > trace.json, build with -DARGB_USE_TRACE=1 -DARGB_USE_QUEUE=1 (see run.sh)
+ */
+
+#include <stdio.h>
+#include "main.h"
+#include "ARGB.h"
+#include "ARGB_TraceJSON.h"
+
+#ifndef DEMO_FPS
+#define DEMO_FPS 400    ///< Short period: queued frames overrun it
+#endif
+#define DEMO_FRAMES 12
+
+extern TIM_HandleTypeDef htim2;
+extern DMA_HandleTypeDef hdma_tim2_ch2_ch4;
+
+static u8_t hue;
+
+static u32_t demo_micros(void) {
+    return DWT->CYCCNT / (ARGB_SIM_SYSCLK / 1000000UL);
+}
+
+static void demo_render(ARGB_Strip *strip, void *ctx) {
+    (void) ctx;
+    ARGB_FillRainbow_Ex(strip, 0, strip->num_pixels, hue, 7, 255, 255);
+    hue += 5;
+}
+
+int main(void) {
+    static ARGB_Pacer pacer;
+    static ARGB_TraceEvent ev[ARGB_TRACE_LEN];
+    const u32_t period = ARGB_SIM_SYSCLK / DEMO_FPS;
+
+    ARGB_Sim_Reset();
+#if ARGB_USE_STREAMING
+    hdma_tim2_ch2_ch4.Init.Mode = DMA_CIRCULAR;
+#endif
+    ARGB_Attach(&htim2, TIM_CHANNEL_2, &hdma_tim2_ch2_ch4, 2 * ARGB_SIM_PCLK1); // TIM2 on APB1
+    ARGB_Init();
+    ARGB_PacerInit(&pacer, &ARGB_DefaultStrip, DEMO_FPS, demo_render, NULL, demo_micros);
+    ARGB_TraceClear();
+
+    for (u32_t i = 0; i < DEMO_FRAMES; i++) {
+        if (DWT->CYCCNT < i * period)       // Idle until the pacing timer interrupt,
+            DWT->CYCCNT = i * period;       // late if the last frame overran
+        ARGB_PacerTick(&pacer);
+        if (i & 1) {
+            ARGB_SetRGB(0, 255, 255, 255);  // Main loop touches a pixel mid-transfer
+            ARGB_Show();
+        }
+        ARGB_Sim_RunDMA(&hdma_tim2_ch2_ch4);
+    }
+
+    const u16_t n = ARGB_TraceRead(ev, ARGB_TRACE_LEN);
+    return ARGB_TraceJSON(stdout, ev, n, ARGB_SIM_SYSCLK / 1000000UL) ? 1 : 0;
+}
@@ -0,0 +1,77 @@
+/**
+ *******************************************
+ * @file    ARGB_TraceJSON.c
+ * @brief   Chrome trace export of the ARGB trace ring (host side)
+ *******************************************
+ */
+
+#include "ARGB_TraceJSON.h"
+
+#define TRACE_MAX_OBJ 16 ///< Strips/groups told apart, the rest share the last tracks
+
+static const char *const s_names[ARGB_EV_COUNT] = {
+    "show", "queued", "encode", "encode", "wire", "dma_half", "dma_cplt", "wire", "render", "render"
+};
+
+const char *ARGB_TraceName(u8_t ev) {
+    return ev < ARGB_EV_COUNT ? s_names[ev] : "?";
+}
+
+/// Phase and track (0 - CPU, 1 - wire) of an event kind
+static char ARGB_TracePhase(u8_t ev, int *wire) {
+    *wire = 0;
+    switch (ev) {
+        case ARGB_EV_ENCODE_BEGIN:
+        case ARGB_EV_RENDER_BEGIN: return 'B';
+        case ARGB_EV_ENCODE_END:
+        case ARGB_EV_RENDER_END: return 'E';
+        case ARGB_EV_DMA_START: *wire = 1; return 'B';
+        case ARGB_EV_FRAME_DONE: *wire = 1; return 'E';
+        default: return 'i';
+    }
+}
+
+int ARGB_TraceJSON(FILE *f, const ARGB_TraceEvent *ev, u32_t n, u32_t cycles_per_us) {
+    const void *objs[TRACE_MAX_OBJ];
+    int depth[TRACE_MAX_OBJ * 2] = {0};
+    int nobj = 0;
+    unsigned long long t = 0;
+    if (cycles_per_us == 0) return -1;
+
+    fprintf(f, "{\"traceEvents\":[\n");
+    for (u32_t i = 0; i < n; i++) {
+        const ARGB_TraceEvent *e = &ev[i];
+        int k = 0;
+        while (k < nobj && objs[k] != e->obj) k++;
+        if (k == nobj) {
+            if (nobj < TRACE_MAX_OBJ) {
+                objs[nobj++] = e->obj;
+                fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                           "\"args\":{\"name\":\"ARGB %d CPU\"}},\n", k * 2, k);
+                fprintf(f, "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                           "\"args\":{\"name\":\"ARGB %d wire\"}},\n", k * 2 + 1, k);
+            } else {
+                k = TRACE_MAX_OBJ - 1;
+            }
+        }
+        if (i) t += (u32_t) (e->t - ev[i - 1].t); // CYCCNT wraps every ~25 s at 168 MHz
+
+        int wire;
+        const char ph = ARGB_TracePhase(e->ev, &wire);
+        const int tid = k * 2 + wire;
+        if (ph == 'E') {
+            if (depth[tid] == 0) continue; // Begin fell out of the ring
+            depth[tid]--;
+        } else if (ph == 'B') {
+            depth[tid]++;
+        }
+        fprintf(f, "{\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%d%s,"
+                   "\"args\":{\"arg\":%u}},\n",
+                ARGB_TraceName(e->ev), ph, (double) t / cycles_per_us, tid,
+                ph == 'i' ? ",\"s\":\"t\"" : "", (unsigned) e->arg);
+    }
+    // Trailing metadata record keeps the list free of a dangling comma
+    fprintf(f, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"ARGB\"}}\n"
+               "],\"displayTimeUnit\":\"ns\"}\n");
+    return ferror(f) ? -1 : 0;
+}
@@ -0,0 +1,30 @@
+/**
+ *******************************************
+ * @file    ARGB_TraceJSON.h
+ * @brief   Chrome trace export of the ARGB trace ring (host side)
+ *******************************************
+ *
+ * @note Output opens in chrome://tracing or https://ui.perfetto.dev. Every
+ *       strip/group gets two tracks: CPU (Show, encode, render, DMA callbacks)
+ *       and wire (DMA start to the end of the reset period).
+ */
+
+#ifndef ARGB_TRACE_JSON_H_
+#define ARGB_TRACE_JSON_H_
+
+#include <stdio.h>
+#include "ARGB.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+const char *ARGB_TraceName(u8_t ev); // Event kind -> short name
+int ARGB_TraceJSON(FILE *f, const ARGB_TraceEvent *ev, u32_t n,
+                   u32_t cycles_per_us); // Write events as Chrome trace JSON, 0 - ok
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ARGB_TRACE_JSON_H_ */
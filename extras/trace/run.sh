@@ -0,0 +1,28 @@
+#!/bin/sh
+# Build the trace demo (full-frame and streaming) and trace2json.
+# Usage: extras/trace/run.sh [out_dir]   -> out_dir/trace_full.json, trace_stream.json
+# Env:   CC (default cc), CFLAGS (default -O2), EXTRA (extra -D options)
+set -e
+
+ROOT=$(cd "$(dirname "$0")/../.." && pwd)
+CC=${CC:-cc}
+CFLAGS=${CFLAGS:-"-O2"}
+DIR=${1:-.}
+OUT=$(mktemp -d)
+trap 'rm -rf "$OUT"' EXIT
+
+for stream in 0 1; do
+    name=$([ $stream = 1 ] && echo stream || echo full)
+    $CC $CFLAGS -DWS2812 -DNUM_PIXELS=60 -DARGB_USE_TRACE=1 -DARGB_TRACE_LEN=2048 -DARGB_USE_QUEUE=1 \
+        -DARGB_USE_STREAMING=$stream $EXTRA \
+        -I"$ROOT/extras/sim" -I"$ROOT/src" -I"$ROOT/extras/trace" \
+        "$ROOT/src/ARGB.c" "$ROOT/extras/sim/ARGB_Sim.c" \
+        "$ROOT/extras/trace/ARGB_TraceJSON.c" "$ROOT/extras/trace/ARGB_TraceDemo.c" \
+        -o "$OUT/trace_demo_$name" -lm
+    "$OUT/trace_demo_$name" > "$DIR/trace_$name.json"
+    echo "$DIR/trace_$name.json"
+done
+
+$CC $CFLAGS -I"$ROOT/extras/sim" -I"$ROOT/src" \
+    "$ROOT/extras/trace/trace2json.c" "$ROOT/extras/trace/ARGB_TraceJSON.c" -o "$DIR/trace2json"
+echo "$DIR/trace2json"
@@ -0,0 +1,40 @@
+/**
+ *******************************************
+ * @file    trace2json.c
+ * @brief   Convert a serial dump of the ARGB trace ring to Chrome trace JSON
+ *******************************************
+ *
+ * @note Input lines (other lines are skipped), as printed by the target:
+ *       trace,<t>,<ev>,<obj>,<arg>   t - CYCCNT, obj - hex address
+ * @note Usage: trace2json [core_mhz] < dump.txt > trace.json   (default 168)
+ * @note Build: cc -Iextras/sim -Isrc extras/trace/trace2json.c extras/trace/ARGB_TraceJSON.c
+ */
+
+#include <stdlib.h>
+#include "ARGB_TraceJSON.h"
+
+int main(int argc, char **argv) {
+    const unsigned long mhz = argc > 1 ? strtoul(argv[1], NULL, 10) : 168;
+    u32_t n = 0, size = 0;
+    ARGB_TraceEvent *ev = NULL;
+    char line[128];
+
+    while (fgets(line, sizeof(line), stdin)) {
+        unsigned long t, obj;
+        unsigned kind, arg;
+        if (sscanf(line, "trace,%lu,%u,%lx,%u", &t, &kind, &obj, &arg) != 4) continue;
+        if (n == size) {
+            size = size ? size * 2 : 256;
+            ev = (ARGB_TraceEvent *) realloc(ev, size * sizeof(*ev));
+            if (ev == NULL) return 1;
+        }
+        ev[n].t = (u32_t) t;
+        ev[n].obj = (const void *) (uintptr_t) obj;
+        ev[n].arg = (u16_t) arg;
+        ev[n].ev = (u8_t) kind;
+        n++;
+    }
+    const int err = ARGB_TraceJSON(stdout, ev, n, (u32_t) mhz);
+    free(ev);
+    return err ? 1 : 0;
+}
@@ -87,15 +87,6 @@
 #define APB2
 #endif
 
-/// DMA Size
-#if defined(DMA_SIZE_BYTE)
-typedef u8_t dma_siz;
-#elif defined(DMA_SIZE_HWORD)
-typedef u16_t dma_siz;
-#elif defined(DMA_SIZE_WORD)
-typedef u32_t dma_siz;
-#endif
-
 // For Arduino/STM32duino: use runtime binding only (no CubeMX externs)
 #if defined(ARDUINO) || defined(ARDUINO_ARCH_STM32)
 #define ARGB_USE_RUNTIME_BINDING
@@ -107,42 +98,207 @@ extern TIM_HandleTypeDef (TIM_HANDLE);  ///< Timer handler
 extern DMA_HandleTypeDef (DMA_HANDLE);  ///< DMA handler
 #endif
 
-// Runtime binding pointers (set by ARGB_Attach)
-static TIM_HandleTypeDef* s_htim = NULL;
-static DMA_HandleTypeDef* s_hdma = NULL;
-static u32_t s_tim_channel = 0;
-static volatile u32_t* s_tim_ccr = NULL;
-static u32_t s_tim_dma_cc = 0;
-static u32_t s_timer_clock_hz = 0;
+#define NUM_BYTES (ARGB_MAX_BYTES_PER_PIXEL * NUM_PIXELS)  ///< Default strip size in bytes, reserved
+#define BITS_PER_PIXEL (ARGB_MAX_BYTES_PER_PIXEL * 8)      ///< 24 (RGB) or 32 (RGBW) bits per pixel, reserved
+#define STRIP_BYTES(strip) ((u16_t) ((strip)->num_pixels * (strip)->led->bpp)) ///< RGB bytes of a whole frame
+#define RST_LEN ARGB_RST_LEN                           ///< Reset period slots
+#define RST_SLOTS ARGB_RST_SLOTS                       ///< Zero slots sent after the data
+#define RST_BYTES ((RST_SLOTS + 7) / 8)                ///< RGB bytes whose PWM slots a prefix reset period covers
+#define PWM_BUF_LEN ((ARGB_PWM_BYTES(NUM_PIXELS) + 3) / 4) ///< Default strip PWM storage, words
+#if (ARGB_USE_STATS || ARGB_USE_TRACE) && defined(DWT)
+#define CYCLES() (DWT->CYCCNT)                         ///< Core cycle counter for stats and trace
+#else
+#define CYCLES() 0U                                    ///< No DWT (Cortex-M0) or stats off
+#endif
+#if ARGB_USE_TRACE
+#if ARGB_TRACE_LEN & (ARGB_TRACE_LEN - 1)
+#error ARGB_TRACE_LEN must be a power of 2
+#endif
+#define TRACE(ev, obj, arg) ARGB_Trace((ev), (obj), (arg))  ///< Record a trace event
+#else
+#define TRACE(ev, obj, arg) ((void) 0)
+#endif
+#if ARGB_USE_STREAMING
+#define PWM_HALF_LEN (ARGB_STREAM_PIXELS * BITS_PER_PIXEL)  ///< Slots in one half of the ping-pong buffer
+#define STREAM_HALF_BYTES (PWM_HALF_LEN / 8)                ///< RGB bytes encoded per half
+#define STRIP_SLOTS(pixels, bpp) (2UL * PWM_HALF_LEN)       ///< PWM slots a strip needs: two halves
+#else
+#define STRIP_SLOTS(pixels, bpp) ((u32_t) (pixels) * (bpp) * 8 + RST_SLOTS) ///< PWM slots a strip needs: frame + reset
+#endif
+#define ARENA_ALIGN (sizeof(void *) > 4 ? sizeof(void *) : 4) ///< Arena carve alignment, DMA words and pointers
+#define ARENA_ROUND(n) (((u32_t) (n) + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN) ///< Bytes a carve takes
+
+#if ARGB_USE_TRACE
+static ARGB_TraceEvent TRACE_BUF[ARGB_TRACE_LEN]; ///< Trace ring
+static u32_t trace_head;                          ///< Events recorded since the last clear
+#endif
+
+/// LED chips, timings as in the tables above
+const ARGB_LedType ARGB_LED_WS2811S = { 400 * 1000, 48, 20, 3, {0, 1, 2, 3} };
+const ARGB_LedType ARGB_LED_WS2811F = { 800 * 1000, 48, 20, 3, {0, 1, 2, 3} };
+const ARGB_LedType ARGB_LED_WS2812 = { 800 * 1000, 56, 28, 3, {1, 0, 2, 3} };
+const ARGB_LedType ARGB_LED_SK6812 = { 800 * 1000, 48, 24, 4, {0, 1, 2, 3} };
+
+#if NUM_PIXELS > 0
+/// Static LED buffer of the default strip
+volatile u8_t RGB_BUF[NUM_BYTES] = {0,};
+
+/// Timer PWM value buffer of the default strip - holds ALL data for complete DMA transfer
+/// (two halves in streaming mode). Slots of ARGB_PWM_WIDTH bytes; the width actually used
+/// is taken from hdma->Init.MemDataAlignment, narrower slots leave the tail unused.
+volatile u32_t PWM_BUF[PWM_BUF_LEN] = {0,};
+
+#if ARGB_USE_DITHER
+/// 8.8 colour and carried fraction of the default strip
+static u16_t DITH_BUF[NUM_BYTES];
+static u8_t DITH_ERR[NUM_BYTES];
+#endif
 
-volatile u8_t PWM_HI;    ///< PWM Code HI Log.1 period
-volatile u8_t PWM_LO;    ///< PWM Code LO Log.1 period
+#if ARGB_QUEUE_COPY
+/// Queued frame of the default strip, copied at ARGB_Show()
+static volatile u8_t Q_BUF[NUM_BYTES];
+#endif
 
-#ifdef SK6812
-#define NUM_BYTES (4 * NUM_PIXELS)          ///< Strip size in bytes (RGBW)
-#define BITS_PER_PIXEL (4 * 8)              ///< 32 bits per RGBW pixel
+/// Strip behind the non-_Ex API
+ARGB_Strip ARGB_DefaultStrip = {
+    .rgb_buf = RGB_BUF,
+    .pwm_buf = PWM_BUF,
+    .pwm_size = sizeof(PWM_BUF),
+    .rgb_size = sizeof(RGB_BUF),
+    .num_pixels = NUM_PIXELS,
+    .led = &ARGB_LED_DEFAULT,
+#if ARGB_USE_DITHER
+    .dith_buf = DITH_BUF,
+    .dith_err = DITH_ERR,
+#endif
+#if ARGB_QUEUE_COPY
+    .q_buf = Q_BUF,
+#endif
+    .br = 255,
+};
 #else
-#define NUM_BYTES (3 * NUM_PIXELS)          ///< Strip size in bytes (RGB)
-#define BITS_PER_PIXEL (3 * 8)              ///< 24 bits per RGB pixel
+/// No storage: NUM_PIXELS 0, strips come from ARGB_STRIP_DEF() or an arena
+ARGB_Strip ARGB_DefaultStrip = { .led = &ARGB_LED_DEFAULT, .br = 255 };
 #endif
 
-#define RST_LEN 60                          ///< Reset period (60+ bits of LOW = 75us @ 800kHz)
-#define PWM_BUF_LEN (NUM_PIXELS * BITS_PER_PIXEL + RST_LEN)  ///< Full buffer for all pixels + reset
+/// Address of PWM slot i of a strip
+#define PWM_SLOT(strip, i) \
+    ((volatile void *) ((volatile u8_t *) (strip)->pwm_buf + (u32_t) (i) * (strip)->pwm_width))
 
-/// Static LED buffer
-volatile u8_t RGB_BUF[NUM_BYTES] = {0,};
+/// Brightness [0..255] -> level scale [0..256], 0 is off
+#define LEVEL_SCALE(br) ((u32_t) (br) + ((br) >> 7))
+
+/// Level -> output byte
+#if ARGB_USE_DITHER
+#define LEVEL_U8(v) ((u8_t) (((v) + 0x80) >> 8))
+#define DITHER_PENDING(strip) ((strip)->dith_frac)
+#else
+#define LEVEL_U8(v) (v)
+#define DITHER_PENDING(strip) 0
+#endif
 
-/// Timer PWM value buffer - holds ALL data for complete DMA transfer
-volatile dma_siz PWM_BUF[PWM_BUF_LEN] = {0,};
+/// ARGB_Show() is copying a queued frame, it starts the frame itself if the strip frees up
+#if ARGB_QUEUE_COPY
+#define QUEUE_COPYING(strip) ((strip)->q_copy)
+#else
+#define QUEUE_COPYING(strip) 0
+#endif
+
+#if USE_GAMMA_CORRECTION
+/// Perceptual curve, 65535 * (i / 255) ^ 2.2
+static const u16_t ARGB_GAMMA[256] = {
+    0x0000, 0x0000, 0x0002, 0x0004, 0x0007, 0x000B, 0x0011, 0x0018,
+    0x0020, 0x002A, 0x0035, 0x0041, 0x004F, 0x005E, 0x006F, 0x0081,
+    0x0094, 0x00A9, 0x00C0, 0x00D8, 0x00F2, 0x010E, 0x012B, 0x014A,
+    0x016A, 0x018C, 0x01B0, 0x01D5, 0x01FC, 0x0225, 0x024F, 0x027B,
+    0x02A9, 0x02D9, 0x030B, 0x033E, 0x0373, 0x03AA, 0x03E3, 0x041D,
+    0x0459, 0x0497, 0x04D7, 0x0519, 0x055D, 0x05A3, 0x05EA, 0x0633,
+    0x067F, 0x06CC, 0x071B, 0x076C, 0x07BF, 0x0814, 0x086B, 0x08C3,
+    0x091E, 0x097B, 0x09D9, 0x0A3A, 0x0A9D, 0x0B01, 0x0B68, 0x0BD0,
+    0x0C3B, 0x0CA8, 0x0D16, 0x0D87, 0x0DFA, 0x0E6E, 0x0EE5, 0x0F5E,
+    0x0FD9, 0x1056, 0x10D5, 0x1156, 0x11DA, 0x125F, 0x12E6, 0x1370,
+    0x13FB, 0x1489, 0x1519, 0x15AB, 0x163F, 0x16D5, 0x176E, 0x1808,
+    0x18A5, 0x1944, 0x19E5, 0x1A88, 0x1B2D, 0x1BD4, 0x1C7E, 0x1D2A,
+    0x1DD8, 0x1E88, 0x1F3A, 0x1FEF, 0x20A6, 0x215F, 0x221A, 0x22D7,
+    0x2397, 0x2459, 0x251D, 0x25E3, 0x26AC, 0x2776, 0x2843, 0x2913,
+    0x29E4, 0x2AB8, 0x2B8E, 0x2C66, 0x2D41, 0x2E1E, 0x2EFD, 0x2FDE,
+    0x30C2, 0x31A8, 0x3290, 0x337B, 0x3468, 0x3557, 0x3648, 0x373C,
+    0x3832, 0x392B, 0x3A25, 0x3B22, 0x3C22, 0x3D24, 0x3E28, 0x3F2E,
+    0x4037, 0x4142, 0x424F, 0x435F, 0x4471, 0x4586, 0x469D, 0x47B6,
+    0x48D2, 0x49F0, 0x4B10, 0x4C33, 0x4D58, 0x4E7F, 0x4FA9, 0x50D6,
+    0x5204, 0x5335, 0x5469, 0x559F, 0x56D7, 0x5812, 0x594F, 0x5A8E,
+    0x5BD0, 0x5D15, 0x5E5C, 0x5FA5, 0x60F1, 0x623F, 0x638F, 0x64E2,
+    0x6638, 0x6790, 0x68EA, 0x6A47, 0x6BA6, 0x6D08, 0x6E6C, 0x6FD3,
+    0x713C, 0x72A7, 0x7415, 0x7586, 0x76F9, 0x786E, 0x79E6, 0x7B61,
+    0x7CDE, 0x7E5D, 0x7FDF, 0x8164, 0x82EA, 0x8474, 0x8600, 0x878E,
+    0x891F, 0x8AB3, 0x8C49, 0x8DE1, 0x8F7C, 0x911A, 0x92BA, 0x945D,
+    0x9602, 0x97A9, 0x9954, 0x9B00, 0x9CB0, 0x9E62, 0xA016, 0xA1CD,
+    0xA386, 0xA542, 0xA701, 0xA8C2, 0xAA86, 0xAC4C, 0xAE15, 0xAFE1,
+    0xB1AF, 0xB37F, 0xB552, 0xB728, 0xB900, 0xBADB, 0xBCB9, 0xBE99,
+    0xC07B, 0xC261, 0xC449, 0xC633, 0xC820, 0xCA10, 0xCC02, 0xCDF7,
+    0xCFEE, 0xD1E8, 0xD3E5, 0xD5E4, 0xD7E6, 0xD9EB, 0xDBF2, 0xDDFC,
+    0xE008, 0xE217, 0xE429, 0xE63D, 0xE854, 0xEA6E, 0xEC8A, 0xEEA9,
+    0xF0CA, 0xF2EE, 0xF515, 0xF73F, 0xF96B, 0xFB9A, 0xFDCB, 0xFFFF
+};
 
-volatile u8_t ARGB_BR = 255;     ///< LED Global brightness
-volatile ARGB_STATE ARGB_LOC_ST; ///< Buffer send status
+/// Per-colour white balance (R, G, B, W), x/255
+static const u8_t ARGB_BALANCE[4] = { 0xFF, 0xB0, 0xF0, 0xFF };
+#endif
 
-static inline u8_t scale8(u8_t x, u8_t scale); // Gamma correction
-static void HSV2RGB(u8_t hue, u8_t sat, u8_t val, u8_t *_r, u8_t *_g, u8_t *_b);
+static u8_t ARGB_DMAWidth(const DMA_HandleTypeDef *hdma);
+static void ARGB_SetupTimer(TIM_TypeDef *tim_inst, u32_t APBfq, const ARGB_LedType *led,
+                            u8_t *pwm_hi, u8_t *pwm_lo);
+static void ARGB_SetupEncoder(ARGB_Strip *strip);
+static void ARGB_ApplyLedType(ARGB_Strip *strip);
+static void *ARGB_ArenaTake(ARGB_Arena *arena, u32_t size);
+#if ARGB_USE_STREAMING
+static void ARGB_StreamFill(ARGB_Strip *strip, u16_t first_slot);
+#endif
+static ARGB_STATE ARGB_Transmit(ARGB_Strip *strip, u16_t end);
+static ARGB_STATE ARGB_Send(ARGB_Strip *strip, u16_t end);
+static ARGB_STATE ARGB_Start(ARGB_Strip *strip, u16_t end, const volatile u8_t *src, u16_t lo, u16_t hi);
+static void ARGB_TakeDirty(ARGB_Strip *strip, u16_t end, u16_t *lo, u16_t *hi);
+#if ARGB_USE_QUEUE
+static u8_t ARGB_Enqueue(ARGB_Strip *strip, u16_t end);
+static void ARGB_StartQueued(ARGB_Strip *strip);
+#endif
+static void ARGB_StopTransfer(ARGB_Strip *strip);
+static void ARGB_FrameDone(ARGB_Strip *strip);
+static void ARGB_DataSent(ARGB_Strip *strip);
+#if ARGB_USE_STREAMING
+static inline void ARGB_Refill(ARGB_Strip *strip, u16_t first_slot);
+#endif
+static inline void ARGB_MarkDirty(ARGB_Strip *strip, u16_t lo, u16_t hi);
+static inline ARGB_Level ARGB_LevelOf(u32_t scale, u8_t c, u8_t x);
+static void ARGB_PackRGB(u8_t *px, const u8_t *order, u8_t br, u8_t r, u8_t g, u8_t b);
+#if ARGB_USE_DITHER
+static void ARGB_PackLevels(u16_t *px, const u8_t *order, u8_t br, u8_t r, u8_t g, u8_t b);
+static void ARGB_Dither(ARGB_Strip *strip, u16_t end);
+#endif
+static void ARGB_ParEncode(ARGB_Parallel *par);
+static void ARGB_ParStop(ARGB_Parallel *par);
+static void ARGB_BurstEncode(ARGB_Burst *burst);
+static void ARGB_BurstStop(ARGB_Burst *burst);
+static inline void ARGB_StoreRGB(ARGB_Strip *strip, u16_t i, u8_t r, u8_t g, u8_t b);
+static inline void ARGB_StoreWhite(ARGB_Strip *strip, u16_t i, u8_t w);
+static u16_t ARGB_ClipSpan(const ARGB_Strip *strip, u16_t offset, u16_t count);
+static inline void HSV2RGB_Int(u8_t hue, u8_t sat, u8_t val, u8_t *_r, u8_t *_g, u8_t *_b);
+static inline void HSV2RGB_Float(u8_t hue, u8_t sat, u8_t val, u8_t *_r, u8_t *_g, u8_t *_b);
+#if ARGB_USE_INT_HSV
+#define HSV2RGB HSV2RGB_Int   ///< HSV conversion used by the driver
+#else
+#define HSV2RGB HSV2RGB_Float
+#endif
 // Callbacks
 static void ARGB_TIM_DMADelayPulseCplt(DMA_HandleTypeDef *hdma);
+#if ARGB_USE_STREAMING
 static void ARGB_TIM_DMADelayPulseHalfCplt(DMA_HandleTypeDef *hdma);
+#endif
+static void ARGB_TIM_DMAError(DMA_HandleTypeDef *hdma);
+static void ARGB_ParDMACplt(DMA_HandleTypeDef *hdma);
+static void ARGB_ParDMAError(DMA_HandleTypeDef *hdma);
+static void ARGB_BurstDMACplt(DMA_HandleTypeDef *hdma);
+static void ARGB_BurstDMAError(DMA_HandleTypeDef *hdma);
 /// @} //Private
 
 /**
@@ -152,21 +308,41 @@ static void ARGB_TIM_DMADelayPulseHalfCplt(DMA_HandleTypeDef *hdma);
  */
 ARGB_STATE ARGB_Attach(TIM_HandleTypeDef* htim, u32_t tim_channel,
                        DMA_HandleTypeDef* hdma, u32_t timer_clock_hz) {
-    if (!htim || !hdma) return ARGB_PARAM_ERR;
-    
-    s_htim = htim;
-    s_hdma = hdma;
-    s_tim_channel = tim_channel;
-    s_timer_clock_hz = timer_clock_hz;
+    return ARGB_Attach_Ex(&ARGB_DefaultStrip, htim, tim_channel, hdma, timer_clock_hz);
+}
+
+/**
+ * @brief Bind a strip to its TIM channel and DMA
+ * @param[in] strip Strip handle
+ * @param[in] htim Timer handle
+ * @param[in] tim_channel TIM_CHANNEL_x
+ * @param[in] hdma DMA handle linked to the channel, must not be shared with other strips
+ * @param[in] timer_clock_hz Timer input clock
+ * @return #ARGB_STATE enum, ARGB_PARAM_ERR if the PWM buffer is too small for the DMA width
+ *         or a frame is longer than one DMA transfer (ARGB_DMA_MAX_XFER slots)
+ */
+ARGB_STATE ARGB_Attach_Ex(ARGB_Strip *strip, TIM_HandleTypeDef* htim, u32_t tim_channel,
+                          DMA_HandleTypeDef* hdma, u32_t timer_clock_hz) {
+    if (!strip || !htim || !hdma) return ARGB_PARAM_ERR;
+    if (STRIP_SLOTS(strip->num_pixels, strip->led->bpp) > ARGB_DMA_MAX_XFER) return ARGB_PARAM_ERR;
+    // PWM slot width follows DMA memory width: BYTE/HALFWORD buffers for
+    // DMAs that zero-extend into the wider CCR, WORD where they can't
+    const u8_t width = ARGB_DMAWidth(hdma);
+    if (STRIP_SLOTS(strip->num_pixels, strip->led->bpp) * width > strip->pwm_size) return ARGB_PARAM_ERR;
     
     // Get CCR register address
     switch (tim_channel) {
-        case TIM_CHANNEL_1: s_tim_ccr = &htim->Instance->CCR1; s_tim_dma_cc = TIM_DMA_CC1; break;
-        case TIM_CHANNEL_2: s_tim_ccr = &htim->Instance->CCR2; s_tim_dma_cc = TIM_DMA_CC2; break;
-        case TIM_CHANNEL_3: s_tim_ccr = &htim->Instance->CCR3; s_tim_dma_cc = TIM_DMA_CC3; break;
-        case TIM_CHANNEL_4: s_tim_ccr = &htim->Instance->CCR4; s_tim_dma_cc = TIM_DMA_CC4; break;
+        case TIM_CHANNEL_1: strip->tim_ccr = &htim->Instance->CCR1; strip->tim_dma_cc = TIM_DMA_CC1; break;
+        case TIM_CHANNEL_2: strip->tim_ccr = &htim->Instance->CCR2; strip->tim_dma_cc = TIM_DMA_CC2; break;
+        case TIM_CHANNEL_3: strip->tim_ccr = &htim->Instance->CCR3; strip->tim_dma_cc = TIM_DMA_CC3; break;
+        case TIM_CHANNEL_4: strip->tim_ccr = &htim->Instance->CCR4; strip->tim_dma_cc = TIM_DMA_CC4; break;
         default: return ARGB_PARAM_ERR;
     }
+    strip->htim = htim;
+    strip->hdma = hdma;
+    strip->tim_channel = tim_channel;
+    strip->timer_clock_hz = timer_clock_hz;
+    strip->pwm_width = width;
     return ARGB_OK;
 }
 
@@ -175,23 +351,11 @@ ARGB_STATE ARGB_Attach(TIM_HandleTypeDef* htim, u32_t tim_channel,
  * @param none
  */
 void ARGB_Init(void) {
-    /* Auto-calculation! */
-    u32_t APBfq; // Clock freq
-    
-    // Use runtime binding if available, otherwise legacy defines
-    TIM_TypeDef* tim_inst;
-    u32_t tim_ch;
-    
-    if (s_htim != NULL) {
-        // Runtime binding mode (ARGB_Attach was called)
-        tim_inst = s_htim->Instance;
-        tim_ch = s_tim_channel;
-        APBfq = s_timer_clock_hz;
-    } else {
+    ARGB_Strip *strip = &ARGB_DefaultStrip;
+    if (strip->htim == NULL) {
 #ifndef ARGB_USE_RUNTIME_BINDING
         // Legacy CubeMX mode
-        tim_inst = TIM_HANDLE.Instance;
-        tim_ch = TIM_CH;
+        u32_t APBfq; // Clock freq
 #ifdef APB1
         APBfq = HAL_RCC_GetPCLK1Freq();
         APBfq *= (RCC->CFGR & RCC_CFGR_PPRE1) == 0 ? 1 : 2;
@@ -199,36 +363,114 @@ void ARGB_Init(void) {
         APBfq = HAL_RCC_GetPCLK2Freq();
         APBfq *= (RCC->CFGR & RCC_CFGR_PPRE2) == 0 ? 1 : 2;
 #endif
+        if (ARGB_Attach_Ex(strip, &TIM_HANDLE, TIM_CH, &DMA_HANDLE, APBfq) != ARGB_OK)
+            return; // DMA memory width is wider than ARGB_PWM_WIDTH
 #else
         return; // No timer configured
 #endif
     }
+    ARGB_Init_Ex(strip);
+}
 
-#ifdef WS2811S
-    APBfq /= (uint32_t) (400 * 1000);  // 400 KHz - 2.5us
-#else
-    APBfq /= (uint32_t) (800 * 1000);  // 800 KHz - 1.25us
+/**
+ * @brief Init timer & prescalers of an attached strip
+ * @param[in] strip Strip handle
+ * @return #ARGB_STATE enum
+ */
+ARGB_STATE ARGB_Init_Ex(ARGB_Strip *strip) {
+    if (strip->htim == NULL) return ARGB_PARAM_ERR;
+    TIM_TypeDef* tim_inst = strip->htim->Instance;
+    ARGB_ApplyLedType(strip);
+#if (ARGB_USE_STATS || ARGB_USE_TRACE) && defined(DWT)
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; // Cycle counter for encode/wire timing
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
 #endif
-    tim_inst->PSC = 0;                        // no prescaler
-    tim_inst->ARR = (uint16_t) (APBfq - 1);   // set timer period
-    tim_inst->EGR = 1;                        // update registers
-    
-#if defined(WS2811F) || defined(WS2811S)
-    PWM_HI = (u8_t) (APBfq * 0.48) - 1;     // Log.1 - 48% - 0.60us/1.2us
-    PWM_LO = (u8_t) (APBfq * 0.20) - 1;     // Log.0 - 20% - 0.25us/0.5us
+#if ARGB_USE_STATS
+    ARGB_ResetStats_Ex(strip);
 #endif
-#ifdef WS2812
-    PWM_HI = (u8_t) (APBfq * 0.56) - 1;     // Log.1 - 56% - 0.70us
-    PWM_LO = (u8_t) (APBfq * 0.28) - 1;     // Log.0 - 28% - 0.35us
+
+    strip->state = ARGB_READY; // Set Ready Flag
+    TIM_CCxChannelCmd(tim_inst, strip->tim_channel, TIM_CCx_ENABLE); // Enable GPIO to IDLE state
+    HAL_Delay(1); // Make some delay
+    return ARGB_OK;
+}
+
+/**
+ * @brief Give the driver memory for strips sized at runtime
+ * @note The start is aligned, lost bytes are not usable
+ * @param[out] arena Arena handle
+ * @param[in] mem Memory, DMA-reachable, lives as long as the strips
+ * @param[in] size Bytes at mem
+ */
+void ARGB_ArenaInit(ARGB_Arena *arena, void *mem, u32_t size) {
+    const u32_t skip = (u32_t) ((ARENA_ALIGN - (uintptr_t) mem % ARENA_ALIGN) % ARENA_ALIGN);
+    arena->base = (u8_t *) mem + skip;
+    arena->size = size > skip ? size - skip : 0;
+    arena->used = 0;
+}
+
+/**
+ * @brief Arena bytes taken by ARGB_ArenaStrip(), exact
+ * @note Strip handle + PWM slots + framebuffer (+ 8.8 levels and error with ARGB_USE_DITHER,
+ *       + queued frame copy with ARGB_USE_QUEUE), each rounded up to the carve alignment
+ * @param[in] pixels Strip length
+ * @param[in] led LED type, NULL - ARGB_LED_DEFAULT
+ * @param[in] pwm_width Bytes per PWM slot of the DMA it will be attached to (1/2/4)
+ * @return Bytes
+ */
+u32_t ARGB_ArenaStripBytes(u16_t pixels, const ARGB_LedType *led, u8_t pwm_width) {
+    if (led == NULL) led = &ARGB_LED_DEFAULT;
+    const u32_t rgb = (u32_t) pixels * led->bpp;
+    u32_t bytes = ARENA_ROUND(sizeof(ARGB_Strip)) + ARENA_ROUND(STRIP_SLOTS(pixels, led->bpp) * pwm_width)
+                + ARENA_ROUND(rgb);
+#if ARGB_USE_DITHER
+    bytes += ARENA_ROUND(rgb * sizeof(u16_t)) + ARENA_ROUND(rgb);
 #endif
-#ifdef SK6812
-    PWM_HI = (u8_t) (APBfq * 0.48) - 1;     // Log.1 - 48% - 0.60us
-    PWM_LO = (u8_t) (APBfq * 0.24) - 1;     // Log.0 - 24% - 0.30us
+#if ARGB_QUEUE_COPY
+    bytes += ARENA_ROUND(rgb);
 #endif
+    return bytes;
+}
 
-    ARGB_LOC_ST = ARGB_READY; // Set Ready Flag
-    TIM_CCxChannelCmd(tim_inst, tim_ch, TIM_CCx_ENABLE); // Enable GPIO to IDLE state
-    HAL_Delay(1); // Make some delay
+/**
+ * @brief Create a strip of `pixels` LEDs in an arena
+ * @note Same as ARGB_STRIP_DEF() at runtime: attach and init the returned strip, use the
+ *       _Ex API on it. Buffers are sized for led exactly, ARGB_SetLedType_Ex() to a type
+ *       with more bytes per pixel fails. arena->used grows by ARGB_ArenaStripBytes().
+ * @param[in] arena Arena handle
+ * @param[in] pixels Strip length, e.g. from a config in flash
+ * @param[in] led LED type, NULL - ARGB_LED_DEFAULT
+ * @param[in] pwm_width Bytes per PWM slot of the DMA it will be attached to (1/2/4)
+ * @return Strip handle, NULL if the arena is too small or a parameter is wrong (a frame
+ *         longer than one DMA transfer, ARGB_DMA_MAX_XFER slots, included)
+ */
+ARGB_Strip *ARGB_ArenaStrip(ARGB_Arena *arena, u16_t pixels, const ARGB_LedType *led, u8_t pwm_width) {
+    if (led == NULL) led = &ARGB_LED_DEFAULT;
+    if (arena == NULL || pixels == 0 || (u32_t) pixels * led->bpp > 0xFFFF) return NULL;
+    if (STRIP_SLOTS(pixels, led->bpp) > ARGB_DMA_MAX_XFER) return NULL;
+    if (pwm_width != 1 && pwm_width != 2 && pwm_width != 4) return NULL;
+    const u32_t bytes = ARGB_ArenaStripBytes(pixels, led, pwm_width);
+    if (bytes > arena->size - arena->used) return NULL; // nothing is taken on failure
+
+    u8_t *mem = arena->base + arena->used;
+    for (u32_t i = 0; i < bytes; i++) mem[i] = 0; // same start as static storage
+    const u32_t rgb = (u32_t) pixels * led->bpp;
+    ARGB_Strip *strip = (ARGB_Strip *) ARGB_ArenaTake(arena, sizeof(ARGB_Strip));
+    strip->pwm_size = STRIP_SLOTS(pixels, led->bpp) * pwm_width;
+    strip->pwm_buf = ARGB_ArenaTake(arena, strip->pwm_size);
+    strip->rgb_size = rgb;
+    strip->rgb_buf = (volatile u8_t *) ARGB_ArenaTake(arena, rgb);
+#if ARGB_USE_DITHER
+    strip->dith_buf = (u16_t *) ARGB_ArenaTake(arena, rgb * sizeof(u16_t));
+    strip->dith_err = (u8_t *) ARGB_ArenaTake(arena, rgb);
+#endif
+#if ARGB_QUEUE_COPY
+    strip->q_buf = (volatile u8_t *) ARGB_ArenaTake(arena, rgb);
+#endif
+    strip->num_pixels = pixels;
+    strip->led = led;
+    strip->br = 255;
+    return strip;
 }
 
 /**
@@ -237,10 +479,17 @@ void ARGB_Init(void) {
  * @note Update strip after that
  */
 void ARGB_Clear(void) {
-    ARGB_FillRGB(0, 0, 0);
-#ifdef SK6812
-    ARGB_FillWhite(0);
-#endif
+    ARGB_Clear_Ex(&ARGB_DefaultStrip);
+}
+
+/**
+ * @brief Fill ALL LEDs of a strip with (0,0,0)
+ * @param[in] strip Strip handle
+ * @note Update strip after that
+ */
+void ARGB_Clear_Ex(ARGB_Strip *strip) {
+    ARGB_FillRGB_Ex(strip, 0, 0, 0);
+    if (strip->led->bpp == 4) ARGB_FillWhite_Ex(strip, 0);
 }
 
 /**
@@ -248,7 +497,50 @@ void ARGB_Clear(void) {
  * @param[in] br Brightness [0..255]
  */
 void ARGB_SetBrightness(u8_t br) {
-    ARGB_BR = br;
+    ARGB_SetBrightness_Ex(&ARGB_DefaultStrip, br);
+}
+
+/**
+ * @brief Set strip brightness
+ * @note 256 steps, applies to pixels set afterwards
+ * @param[in] strip Strip handle
+ * @param[in] br Brightness [0..255]
+ */
+void ARGB_SetBrightness_Ex(ARGB_Strip *strip, u8_t br) {
+    strip->br = br;
+}
+
+/**
+ * @brief Select LED chip of the default strip
+ * @param[in] led LED type, e.g. &ARGB_LED_SK6812
+ * @return #ARGB_STATE enum
+ */
+ARGB_STATE ARGB_SetLedType(const ARGB_LedType *led) {
+    return ARGB_SetLedType_Ex(&ARGB_DefaultStrip, led);
+}
+
+/**
+ * @brief Select LED chip of a strip: bit rate, PWM codes, pixel size, colour order
+ * @note Before ARGB_Init_Ex() it only records the type. An initialized strip must be
+ *       idle: timer period, nibble table and reset period are rebuilt at once and the
+ *       next Show sends the whole frame. Pixels already set keep the old layout, set
+ *       them again.
+ * @param[in] strip Strip handle
+ * @param[in] led LED type, must fit the strip's buffers (ARGB_MAX_BYTES_PER_PIXEL)
+ * @return #ARGB_STATE enum, ARGB_BUSY while a frame is on the wire
+ */
+ARGB_STATE ARGB_SetLedType_Ex(ARGB_Strip *strip, const ARGB_LedType *led) {
+    if (!strip || !led || led->bit_hz == 0 || led->bpp < 3 || led->bpp > 4) return ARGB_PARAM_ERR;
+    if ((u32_t) strip->num_pixels * led->bpp > strip->rgb_size) return ARGB_PARAM_ERR;
+    if (STRIP_SLOTS(strip->num_pixels, led->bpp) * strip->pwm_width > strip->pwm_size) return ARGB_PARAM_ERR;
+    if (STRIP_SLOTS(strip->num_pixels, led->bpp) > ARGB_DMA_MAX_XFER) return ARGB_PARAM_ERR;
+    for (u8_t c = 0; c < led->bpp; c++)
+        if (led->order[c] >= led->bpp) return ARGB_PARAM_ERR;
+    const u8_t ready = strip->pwm_hi != 0; // 0 until ARGB_Init_Ex()
+    if (ready && strip->state == ARGB_BUSY) return ARGB_BUSY;
+    strip->led = led;
+    if (ready) ARGB_ApplyLedType(strip);
+    return ARGB_OK;
 }
 
 /**
@@ -259,40 +551,149 @@ void ARGB_SetBrightness(u8_t br) {
  * @param[in] b Blue component  [0..255]
  */
 void ARGB_SetRGB(u16_t i, u8_t r, u8_t g, u8_t b) {
+    ARGB_SetRGB_Ex(&ARGB_DefaultStrip, i, r, g, b);
+}
+
+/**
+ * @brief Set LED of a strip with RGB color by index
+ * @param[in] strip Strip handle
+ * @param[in] i LED position
+ * @param[in] r Red component   [0..255]
+ * @param[in] g Green component [0..255]
+ * @param[in] b Blue component  [0..255]
+ */
+void ARGB_SetRGB_Ex(ARGB_Strip *strip, u16_t i, u8_t r, u8_t g, u8_t b) {
     // overflow protection
-    if (i >= NUM_PIXELS) {
-        u16_t _i = i / NUM_PIXELS;
-        i -= _i * NUM_PIXELS;
-    }
-    // set brightness
-    r /= 256 / ((u16_t) ARGB_BR + 1);
-    g /= 256 / ((u16_t) ARGB_BR + 1);
-    b /= 256 / ((u16_t) ARGB_BR + 1);
+    if (i >= strip->num_pixels) {
+        if (strip->num_pixels == 0) return; // NUM_PIXELS 0 default strip
+        u16_t _i = i / strip->num_pixels;
+        i -= _i * strip->num_pixels;
+    }
+    ARGB_StoreRGB(strip, i, r, g, b);
+    ARGB_MarkDirty(strip, strip->led->bpp * i, strip->led->bpp * (i + 1));
+}
+
+/**
+ * @brief Private method for storing colour of pixel i through the brightness (+gamma) curve
+ * @note Dirty range is left to the caller
+ * @param[in] strip Strip handle
+ * @param[in] i LED position, in range
+ * @param[in] r Red component   [0..255]
+ * @param[in] g Green component [0..255]
+ * @param[in] b Blue component  [0..255]
+ */
+static inline void ARGB_StoreRGB(ARGB_Strip *strip, u16_t i, u8_t r, u8_t g, u8_t b) {
+    const ARGB_LedType *led = strip->led;
+#if ARGB_USE_DITHER
+    ARGB_PackLevels(&strip->dith_buf[led->bpp * i], led->order, strip->br, r, g, b);
+#else
+    ARGB_PackRGB((u8_t *) &strip->rgb_buf[led->bpp * i], led->order, strip->br, r, g, b);
+#endif
+}
+
+/**
+ * @brief Private method for storing white of pixel i through the brightness (+gamma) curve
+ * @note No effect on RGB strips, dirty range is left to the caller
+ * @param[in] strip Strip handle
+ * @param[in] i LED position, in range
+ * @param[in] w White component [0..255]
+ */
+static inline void ARGB_StoreWhite(ARGB_Strip *strip, u16_t i, u8_t w) {
+#if ARGB_MAX_BYTES_PER_PIXEL < 4
+    (void) strip; (void) i; (void) w;
+#else
+    const ARGB_LedType *led = strip->led;
+    if (led->bpp < 4) return;
+#if ARGB_USE_DITHER
+    strip->dith_buf[4 * i + led->order[3]] = ARGB_LevelOf(LEVEL_SCALE(strip->br), 3, w);
+#else
+    strip->rgb_buf[4 * i + led->order[3]] = ARGB_LevelOf(LEVEL_SCALE(strip->br), 3, w);
+#endif
+#endif
+}
+
+/**
+ * @brief Private method for growing the changed byte range of a strip
+ * @note IRQ-safe, the DMA ISR gives back the bytes of a frame it could not send
+ * @param[in] strip Strip handle
+ * @param[in] lo First changed byte
+ * @param[in] hi End of changed bytes
+ */
+static inline void ARGB_MarkDirty(ARGB_Strip *strip, u16_t lo, u16_t hi) {
+    const u32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (strip->dirty_lo >= strip->dirty_hi) {
+        strip->dirty_lo = lo;
+        strip->dirty_hi = hi;
+    } else {
+        if (lo < strip->dirty_lo) strip->dirty_lo = lo;
+        if (hi > strip->dirty_hi) strip->dirty_hi = hi;
+    }
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Private method for the output level of one colour byte
+ * @note Linear scale, or gamma curve + white balance with USE_GAMMA_CORRECTION.
+ *       8.8 fixed point levels with ARGB_USE_DITHER. One multiply per step and a
+ *       shared const curve, nothing per strip to build or keep in RAM.
+ * @param[in] scale LEVEL_SCALE() of the brightness
+ * @param[in] c Colour 0..3 = R, G, B, W
+ * @param[in] x Colour value [0..255]
+ * @return Output level
+ */
+static inline ARGB_Level ARGB_LevelOf(u32_t scale, u8_t c, u8_t x) {
 #if USE_GAMMA_CORRECTION
-    g = scale8(g, 0xB0);
-    b = scale8(b, 0xF0);
-#endif
-    // Subpixel chain order
-#if defined(SK6812) || defined(WS2811F) || defined(WS2811S)
-    const u8_t subp1 = r;
-    const u8_t subp2 = g;
-    const u8_t subp3 = b;
+    const u32_t lin = (ARGB_GAMMA[x] * scale) >> 8; // 16-bit, keeps low-end steps
+#if ARGB_USE_DITHER
+    return (u16_t) ((lin * ARGB_BALANCE[c] + 0x80) >> 8);
+#else
+    return (u8_t) ((lin * ARGB_BALANCE[c] + 0x8000) >> 16);
+#endif
 #else
-    const u8_t subp1 = g;
-    const u8_t subp2 = r;
-    const u8_t subp3 = b;
-#endif
-    // RGB or RGBW
-#ifdef SK6812
-    RGB_BUF[4 * i] = subp1;     // subpixel 1
-    RGB_BUF[4 * i + 1] = subp2; // subpixel 2
-    RGB_BUF[4 * i + 2] = subp3; // subpixel 3
+    (void) c;
+#if ARGB_USE_DITHER
+    return (u16_t) (x * scale);
 #else
-    RGB_BUF[3 * i] = subp1;     // subpixel 1
-    RGB_BUF[3 * i + 1] = subp2; // subpixel 2
-    RGB_BUF[3 * i + 2] = subp3; // subpixel 3
+    return (u8_t) ((x * scale) >> 8);
 #endif
+#endif
+}
+
+/**
+ * @brief Private method for storing one pixel in wire order
+ * @param[out] px First byte of the pixel
+ * @param[in] order Wire byte of R, G, B (ARGB_LedType::order)
+ * @param[in] br Brightness [0..255]
+ * @param[in] r Red component   [0..255]
+ * @param[in] g Green component [0..255]
+ * @param[in] b Blue component  [0..255]
+ */
+static void ARGB_PackRGB(u8_t *px, const u8_t *order, u8_t br, u8_t r, u8_t g, u8_t b) {
+    // set brightness (+gamma), no divides; subpixel chain order of the chip
+    const u32_t scale = LEVEL_SCALE(br);
+    px[order[0]] = LEVEL_U8(ARGB_LevelOf(scale, 0, r));
+    px[order[1]] = LEVEL_U8(ARGB_LevelOf(scale, 1, g));
+    px[order[2]] = LEVEL_U8(ARGB_LevelOf(scale, 2, b));
+}
+
+#if ARGB_USE_DITHER
+/**
+ * @brief Private method for storing 8.8 levels of one pixel in wire order
+ * @param[out] px First level of the pixel
+ * @param[in] order Wire byte of R, G, B (ARGB_LedType::order)
+ * @param[in] br Brightness [0..255]
+ * @param[in] r Red component   [0..255]
+ * @param[in] g Green component [0..255]
+ * @param[in] b Blue component  [0..255]
+ */
+static void ARGB_PackLevels(u16_t *px, const u8_t *order, u8_t br, u8_t r, u8_t g, u8_t b) {
+    const u32_t scale = LEVEL_SCALE(br);
+    px[order[0]] = ARGB_LevelOf(scale, 0, r);
+    px[order[1]] = ARGB_LevelOf(scale, 1, g);
+    px[order[2]] = ARGB_LevelOf(scale, 2, b);
 }
+#endif
 
 /**
  * @brief Set LED with HSV color by index
@@ -302,9 +703,21 @@ void ARGB_SetRGB(u16_t i, u8_t r, u8_t g, u8_t b) {
  * @param[in] val Value (brightness) [0..255]
  */
 void ARGB_SetHSV(u16_t i, u8_t hue, u8_t sat, u8_t val) {
+    ARGB_SetHSV_Ex(&ARGB_DefaultStrip, i, hue, sat, val);
+}
+
+/**
+ * @brief Set LED of a strip with HSV color by index
+ * @param[in] strip Strip handle
+ * @param[in] i LED position
+ * @param[in] hue HUE (color) [0..255]
+ * @param[in] sat Saturation  [0..255]
+ * @param[in] val Value (brightness) [0..255]
+ */
+void ARGB_SetHSV_Ex(ARGB_Strip *strip, u16_t i, u8_t hue, u8_t sat, u8_t val) {
     uint8_t _r, _g, _b;                    // init buffer color
     HSV2RGB(hue, sat, val, &_r, &_g, &_b); // get RGB color
-    ARGB_SetRGB(i, _r, _g, _b);     // set color
+    ARGB_SetRGB_Ex(strip, i, _r, _g, _b);  // set color
 }
 
 /**
@@ -313,11 +726,20 @@ void ARGB_SetHSV(u16_t i, u8_t hue, u8_t sat, u8_t val) {
  * @param[in] w White component [0..255]
  */
 void ARGB_SetWhite(u16_t i, u8_t w) {
-#ifdef RGB
-    return;
-#endif
-    w /= 256 / ((u16_t) ARGB_BR + 1); // set brightness
-    RGB_BUF[4 * i + 3] = w;                // set white part
+    ARGB_SetWhite_Ex(&ARGB_DefaultStrip, i, w);
+}
+
+/**
+ * @brief Set White component of a strip by index
+ * @param[in] strip Strip handle
+ * @param[in] i LED position
+ * @param[in] w White component [0..255]
+ * @note No effect on RGB strips
+ */
+void ARGB_SetWhite_Ex(ARGB_Strip *strip, u16_t i, u8_t w) {
+    if (strip->led->bpp < 4 || i >= strip->num_pixels) return;
+    ARGB_StoreWhite(strip, i, w); // set white part
+    ARGB_MarkDirty(strip, 4 * i, 4 * i + 4); // whole pixel, ARGB_ShowPrefix() needs the boundary
 }
 
 /**
@@ -327,8 +749,34 @@ void ARGB_SetWhite(u16_t i, u8_t w) {
  * @param[in] b Blue component  [0..255]
  */
 void ARGB_FillRGB(u8_t r, u8_t g, u8_t b) {
-    for (volatile u16_t i = 0; i < NUM_PIXELS; i++)
-        ARGB_SetRGB(i, r, g, b);
+    ARGB_FillRGB_Ex(&ARGB_DefaultStrip, r, g, b);
+}
+
+/**
+ * @brief Fill ALL LEDs of a strip with RGB color
+ * @param[in] strip Strip handle
+ * @param[in] r Red component   [0..255]
+ * @param[in] g Green component [0..255]
+ * @param[in] b Blue component  [0..255]
+ */
+void ARGB_FillRGB_Ex(ARGB_Strip *strip, u8_t r, u8_t g, u8_t b) {
+    const ARGB_LedType *led = strip->led;
+    const u8_t o0 = led->order[0], o1 = led->order[1], o2 = led->order[2], bpp = led->bpp;
+#if ARGB_USE_DITHER
+    u16_t px[4];
+    ARGB_PackLevels(px, led->order, strip->br, r, g, b); // pack once, copy to every pixel
+    u16_t *dst = strip->dith_buf;
+#else
+    u8_t px[4];
+    ARGB_PackRGB(px, led->order, strip->br, r, g, b);    // pack once, copy to every pixel
+    volatile u8_t *dst = strip->rgb_buf;
+#endif
+    for (u16_t i = 0; i < strip->num_pixels; i++, dst += bpp) {
+        dst[o0] = px[o0];
+        dst[o1] = px[o1];
+        dst[o2] = px[o2]; // white is kept
+    }
+    ARGB_MarkDirty(strip, 0, STRIP_BYTES(strip));
 }
 
 /**
@@ -338,160 +786,1502 @@ void ARGB_FillRGB(u8_t r, u8_t g, u8_t b) {
  * @param[in] val Value (brightness) [0..255]
  */
 void ARGB_FillHSV(u8_t hue, u8_t sat, u8_t val) {
+    ARGB_FillHSV_Ex(&ARGB_DefaultStrip, hue, sat, val);
+}
+
+/**
+ * @brief Fill ALL LEDs of a strip with HSV color
+ * @param[in] strip Strip handle
+ * @param[in] hue HUE (color) [0..255]
+ * @param[in] sat Saturation  [0..255]
+ * @param[in] val Value (brightness) [0..255]
+ */
+void ARGB_FillHSV_Ex(ARGB_Strip *strip, u8_t hue, u8_t sat, u8_t val) {
     uint8_t _r, _g, _b;                    // init buffer color
     HSV2RGB(hue, sat, val, &_r, &_g, &_b); // get color once (!)
-    ARGB_FillRGB(_r, _g, _b);       // set color
+    ARGB_FillRGB_Ex(strip, _r, _g, _b);    // set color
 }
 
 /**
- * @brief Set ALL White components in strip
- * @param[in] w White component [0..255]
+ * @brief Fill a range of LEDs with a hue ramp
+ * @param[in] start First LED
+ * @param[in] count LEDs to fill, clipped to the strip end
+ * @param[in] hue0 HUE of the first LED [0..255]
+ * @param[in] dhue HUE step per LED (wraps around)
+ * @param[in] sat Saturation  [0..255]
+ * @param[in] val Value (brightness) [0..255]
  */
-void ARGB_FillWhite(u8_t w) {
-    for (volatile u16_t i = 0; i < NUM_PIXELS; i++)
-        ARGB_SetWhite(i, w);
+void ARGB_FillRainbow(u16_t start, u16_t count, u8_t hue0, u8_t dhue, u8_t sat, u8_t val) {
+    ARGB_FillRainbow_Ex(&ARGB_DefaultStrip, start, count, hue0, dhue, sat, val);
 }
 
 /**
- * @brief Get current DMA status
- * @param none
- * @return #ARGB_STATE enum
+ * @brief Fill a range of LEDs of a strip with a hue ramp
+ * @note One loop over the range, the dirty range is updated once
+ * @param[in] strip Strip handle
+ * @param[in] start First LED
+ * @param[in] count LEDs to fill, clipped to the strip end
+ * @param[in] hue0 HUE of the first LED [0..255]
+ * @param[in] dhue HUE step per LED (wraps around)
+ * @param[in] sat Saturation  [0..255]
+ * @param[in] val Value (brightness) [0..255]
  */
-ARGB_STATE ARGB_Ready(void) {
-    return ARGB_LOC_ST;
+void ARGB_FillRainbow_Ex(ARGB_Strip *strip, u16_t start, u16_t count,
+                         u8_t hue0, u8_t dhue, u8_t sat, u8_t val) {
+    count = ARGB_ClipSpan(strip, start, count);
+    if (count == 0) return;
+    const u16_t end = start + count;
+    u8_t hue = hue0;
+    for (u16_t i = start; i < end; i++, hue += dhue) {
+        u8_t _r, _g, _b;
+        HSV2RGB(hue, sat, val, &_r, &_g, &_b);
+        ARGB_StoreRGB(strip, i, _r, _g, _b);
+    }
+    ARGB_MarkDirty(strip, strip->led->bpp * start, strip->led->bpp * end);
 }
 
 /**
- * @brief Update strip - fills entire PWM buffer and starts single DMA transfer
- * @param none
- * @return #ARGB_STATE enum
+ * @brief Load a span of LEDs from packed R,G,B bytes
+ * @param[in] offset First LED
+ * @param[in] rgb 3 bytes per LED, R first
+ * @param[in] count LEDs, clipped to the strip end
  */
-ARGB_STATE ARGB_Show(void) {
-    // Get handles - runtime or legacy
-    TIM_HandleTypeDef* htim;
-    DMA_HandleTypeDef* hdma;
-    u32_t tim_ch, tim_dma_cc;
-    volatile u32_t* ccr_reg;
-    
-    if (s_htim != NULL) {
-        htim = s_htim;
-        hdma = s_hdma;
-        tim_ch = s_tim_channel;
-        tim_dma_cc = s_tim_dma_cc;
-        ccr_reg = s_tim_ccr;
-    } else {
-#ifndef ARGB_USE_RUNTIME_BINDING
-        htim = &TIM_HANDLE;
-        hdma = &DMA_HANDLE;
-        tim_ch = TIM_CH;
-#if TIM_CH == TIM_CHANNEL_1
-        tim_dma_cc = TIM_DMA_CC1;
-        ccr_reg = &htim->Instance->CCR1;
-#elif TIM_CH == TIM_CHANNEL_2
-        tim_dma_cc = TIM_DMA_CC2;
-        ccr_reg = &htim->Instance->CCR2;
-#elif TIM_CH == TIM_CHANNEL_3
-        tim_dma_cc = TIM_DMA_CC3;
-        ccr_reg = &htim->Instance->CCR3;
-#else
-        tim_dma_cc = TIM_DMA_CC4;
-        ccr_reg = &htim->Instance->CCR4;
-#endif
-#else
-        return ARGB_PARAM_ERR;
-#endif
-    }
+void ARGB_WritePixels(u16_t offset, const u8_t *rgb, u16_t count) {
+    ARGB_WritePixels_Ex(&ARGB_DefaultStrip, offset, rgb, count);
+}
 
-    // Check if DMA is ready
-    if (ARGB_LOC_ST == ARGB_BUSY || hdma->State != HAL_DMA_STATE_READY) {
-        return ARGB_BUSY;
-    }
-    ARGB_LOC_ST = ARGB_BUSY;
-    
-    // Fill ENTIRE PWM buffer with all pixel data
-    u16_t pwm_idx = 0;
-    for (u16_t byte_idx = 0; byte_idx < NUM_BYTES; byte_idx++) {
-        u8_t byte_val = RGB_BUF[byte_idx];
-        for (u8_t bit = 0; bit < 8; bit++) {
-            PWM_BUF[pwm_idx++] = (byte_val & 0x80) ? PWM_HI : PWM_LO;
-            byte_val <<= 1;
-        }
-    }
-    
-    // Add reset period (zeros for LOW signal)
-    for (u16_t i = 0; i < RST_LEN; i++) {
-        PWM_BUF[pwm_idx++] = 0;
-    }
-    
-    // Clear CCR before starting to avoid initial glitch
-    *ccr_reg = 0;
-    htim->Instance->CNT = 0;
-    __HAL_TIM_CLEAR_FLAG(htim, TIM_FLAG_UPDATE | TIM_FLAG_CC1 | TIM_FLAG_CC2 | TIM_FLAG_CC3 | TIM_FLAG_CC4);
-    
-    // Get DMA ID from channel
-    u32_t dma_id = (tim_ch == TIM_CHANNEL_1) ? TIM_DMA_ID_CC1 :
-                   (tim_ch == TIM_CHANNEL_2) ? TIM_DMA_ID_CC2 :
-                   (tim_ch == TIM_CHANNEL_3) ? TIM_DMA_ID_CC3 : TIM_DMA_ID_CC4;
-    
-    // Set channel state
-    TIM_CHANNEL_STATE_SET(htim, tim_ch, HAL_TIM_CHANNEL_STATE_BUSY);
-    
-    // Setup callbacks
-    htim->hdma[dma_id]->XferCpltCallback = ARGB_TIM_DMADelayPulseCplt;
-    htim->hdma[dma_id]->XferHalfCpltCallback = NULL;  // Not needed for NORMAL mode
-    htim->hdma[dma_id]->XferErrorCallback = TIM_DMAError;
-    
-    // Start DMA for entire buffer
-    if (HAL_DMA_Start_IT(htim->hdma[dma_id], (u32_t)PWM_BUF,
-                         (u32_t)ccr_reg, (u16_t)PWM_BUF_LEN) != HAL_OK) {
-        ARGB_LOC_ST = ARGB_READY;
-        TIM_CHANNEL_STATE_SET(htim, tim_ch, HAL_TIM_CHANNEL_STATE_READY);
-        return ARGB_PARAM_ERR;
-    }
-    
-    // Enable DMA request from timer
-    __HAL_TIM_ENABLE_DMA(htim, tim_dma_cc);
-    
-    // Enable timer output for advanced timers (TIM1, TIM8)
-    if (IS_TIM_BREAK_INSTANCE(htim->Instance) != RESET)
-        __HAL_TIM_MOE_ENABLE(htim);
-    
-    // Start timer
-    __HAL_TIM_ENABLE(htim);
-    
-    return ARGB_OK;
+/**
+ * @brief Load a span of LEDs from packed R,G,B,W bytes
+ * @note White is ignored on RGB strips
+ * @param[in] offset First LED
+ * @param[in] rgbw 4 bytes per LED, R first
+ * @param[in] count LEDs, clipped to the strip end
+ */
+void ARGB_WritePixelsRGBW(u16_t offset, const u8_t *rgbw, u16_t count) {
+    ARGB_WritePixelsRGBW_Ex(&ARGB_DefaultStrip, offset, rgbw, count);
 }
 
 /**
- * @addtogroup Private_entities
- * @{ */
+ * @brief Load a span of LEDs from 0xWWRRGGBB words
+ * @note White is ignored on RGB strips
+ * @param[in] offset First LED
+ * @param[in] wrgb One word per LED
+ * @param[in] count LEDs, clipped to the strip end
+ */
+void ARGB_WritePixels32(u16_t offset, const u32_t *wrgb, u16_t count) {
+    ARGB_WritePixels32_Ex(&ARGB_DefaultStrip, offset, wrgb, count);
+}
 
 /**
- * @brief Private method for gamma correction
- * @param[in] x Param to scale
- * @param[in] scale Scale coefficient
- * @return Scaled value
+ * @brief Load a span of LEDs of a strip from packed R,G,B bytes
+ * @note Brightness and wire order applied in one pass, the dirty range is updated once
+ * @param[in] strip Strip handle
+ * @param[in] offset First LED
+ * @param[in] rgb 3 bytes per LED, R first
+ * @param[in] count LEDs, clipped to the strip end
  */
-static inline u8_t scale8(u8_t x, u8_t scale) {
-    return ((uint16_t) x * scale) >> 8;
+void ARGB_WritePixels_Ex(ARGB_Strip *strip, u16_t offset, const u8_t *rgb, u16_t count) {
+    count = ARGB_ClipSpan(strip, offset, count);
+    if (count == 0) return;
+    const u16_t end = offset + count;
+    for (u16_t i = offset; i < end; i++, rgb += 3)
+        ARGB_StoreRGB(strip, i, rgb[0], rgb[1], rgb[2]);
+    ARGB_MarkDirty(strip, strip->led->bpp * offset, strip->led->bpp * end);
 }
 
 /**
- * @brief Convert color in HSV to RGB
- * @param[in] hue HUE (color) [0..255]
- * @param[in] sat Saturation  [0..255]
- * @param[in] val Value (brightness) [0..255]
- * @param[out] _r Pointer to RED component value
- * @param[out] _g Pointer to GREEN component value
- * @param[out] _b Pointer to BLUE component value
+ * @brief Load a span of LEDs of a strip from packed R,G,B,W bytes
+ * @note White is ignored on RGB strips
+ * @param[in] strip Strip handle
+ * @param[in] offset First LED
+ * @param[in] rgbw 4 bytes per LED, R first
+ * @param[in] count LEDs, clipped to the strip end
  */
-static void HSV2RGB(u8_t hue, u8_t sat, u8_t val, u8_t *_r, u8_t *_g, u8_t *_b) {
-    if (sat == 0) { // if white color
-        *_r = *_g = *_b = val;
-        return;
+void ARGB_WritePixelsRGBW_Ex(ARGB_Strip *strip, u16_t offset, const u8_t *rgbw, u16_t count) {
+    count = ARGB_ClipSpan(strip, offset, count);
+    if (count == 0) return;
+    const u16_t end = offset + count;
+    for (u16_t i = offset; i < end; i++, rgbw += 4) {
+        ARGB_StoreRGB(strip, i, rgbw[0], rgbw[1], rgbw[2]);
+        ARGB_StoreWhite(strip, i, rgbw[3]);
     }
-    // Float is smoother but check for FPU (Floating point unit) in your MCU
-    // Otherwise it will take longer time in the code
+    ARGB_MarkDirty(strip, strip->led->bpp * offset, strip->led->bpp * end);
+}
+
+/**
+ * @brief Load a span of LEDs of a strip from 0xWWRRGGBB words
+ * @note White is ignored on RGB strips
+ * @param[in] strip Strip handle
+ * @param[in] offset First LED
+ * @param[in] wrgb One word per LED
+ * @param[in] count LEDs, clipped to the strip end
+ */
+void ARGB_WritePixels32_Ex(ARGB_Strip *strip, u16_t offset, const u32_t *wrgb, u16_t count) {
+    count = ARGB_ClipSpan(strip, offset, count);
+    if (count == 0) return;
+    const u16_t end = offset + count;
+    for (u16_t i = offset; i < end; i++) {
+        const u32_t px = *wrgb++;
+        ARGB_StoreRGB(strip, i, (u8_t) (px >> 16), (u8_t) (px >> 8), (u8_t) px);
+        ARGB_StoreWhite(strip, i, (u8_t) (px >> 24));
+    }
+    ARGB_MarkDirty(strip, strip->led->bpp * offset, strip->led->bpp * end);
+}
+
+/**
+ * @brief Private method for clipping a span of LEDs to the strip
+ * @param[in] strip Strip handle
+ * @param[in] offset First LED
+ * @param[in] count Requested LEDs
+ * @return LEDs inside the strip, 0 if offset is past the end
+ */
+static u16_t ARGB_ClipSpan(const ARGB_Strip *strip, u16_t offset, u16_t count) {
+    if (offset >= strip->num_pixels) return 0;
+    return count > strip->num_pixels - offset ? strip->num_pixels - offset : count;
+}
+
+/**
+ * @brief Set ALL White components in strip
+ * @param[in] w White component [0..255]
+ */
+void ARGB_FillWhite(u8_t w) {
+    ARGB_FillWhite_Ex(&ARGB_DefaultStrip, w);
+}
+
+/**
+ * @brief Set ALL White components of a strip
+ * @param[in] strip Strip handle
+ * @param[in] w White component [0..255]
+ */
+void ARGB_FillWhite_Ex(ARGB_Strip *strip, u8_t w) {
+    for (volatile u16_t i = 0; i < strip->num_pixels; i++)
+        ARGB_SetWhite_Ex(strip, i, w);
+}
+
+/**
+ * @brief Get current DMA status
+ * @param none
+ * @return #ARGB_STATE enum
+ */
+ARGB_STATE ARGB_Ready(void) {
+    return ARGB_Ready_Ex(&ARGB_DefaultStrip);
+}
+
+/**
+ * @brief Get current DMA status of a strip
+ * @param[in] strip Strip handle
+ * @return #ARGB_STATE enum
+ */
+ARGB_STATE ARGB_Ready_Ex(const ARGB_Strip *strip) {
+    return strip->state;
+}
+
+#if ARGB_USE_HW_LATCH
+/**
+ * @brief Timer interrupt of the default strip, call it from TIMx_IRQHandler()
+ * @param none
+ */
+void ARGB_TIM_IRQHandler(void) {
+    ARGB_TIM_IRQHandler_Ex(&ARGB_DefaultStrip);
+}
+
+/**
+ * @brief Timer interrupt of a strip: end of the reset period
+ * @note The strip is released here, the queued frame starts right away and
+ *       the OnComplete callback runs in this interrupt. Ignores other update
+ *       sources, so a shared vector may call it for every strip on it.
+ * @param[in] strip Strip handle
+ */
+void ARGB_TIM_IRQHandler_Ex(ARGB_Strip *strip) {
+    TIM_HandleTypeDef *htim = strip->htim;
+    if (htim == NULL || !(htim->Instance->DIER & TIM_IT_UPDATE) || !(htim->Instance->SR & TIM_FLAG_UPDATE))
+        return;
+    __HAL_TIM_DISABLE_IT(htim, TIM_IT_UPDATE);
+    htim->Instance->PSC = 0;          // Back to slot timing
+    htim->Instance->EGR = TIM_EGR_UG; // Load it now, the line stays LOW (CCR = 0)
+    __HAL_TIM_CLEAR_FLAG(htim, TIM_FLAG_UPDATE);
+    ARGB_FrameDone(strip);
+}
+#endif
+
+/**
+ * @brief Register a frame complete callback
+ * @param[in] fn Callback, NULL - none
+ * @param[in] ctx Passed to fn as is
+ */
+void ARGB_OnComplete(ARGB_DoneFn fn, void *ctx) {
+    ARGB_OnComplete_Ex(&ARGB_DefaultStrip, fn, ctx);
+}
+
+/**
+ * @brief Register a frame complete callback of a strip
+ * @note fn runs in the DMA interrupt after the reset period of every frame, once the
+ *       strip is released: it may call ARGB_Show_Ex(). A frame queued during the
+ *       transfer is already started, ARGB_Ready_Ex() tells if the strip is free.
+ *       See ARGB_RTOS.h for semaphore / task notification callbacks.
+ * @param[in] strip Strip handle
+ * @param[in] fn Callback, NULL - none
+ * @param[in] ctx Passed to fn as is
+ */
+void ARGB_OnComplete_Ex(ARGB_Strip *strip, ARGB_DoneFn fn, void *ctx) {
+    const u32_t primask = __get_PRIMASK();
+    __disable_irq(); // ISR never sees a new fn with the old ctx
+    strip->on_done = fn;
+    strip->done_ctx = ctx;
+    __set_PRIMASK(primask);
+}
+
+#if ARGB_USE_STATS
+/**
+ * @brief Read counters of the default strip
+ * @param[out] stats Snapshot, see #ARGB_Stats
+ */
+void ARGB_GetStats(ARGB_Stats *stats) {
+    ARGB_GetStats_Ex(&ARGB_DefaultStrip, stats);
+}
+
+/**
+ * @brief Read counters of a strip
+ * @note Cycles are DWT->CYCCNT core clocks, divide by SystemCoreClock for seconds.
+ *       FPS drops to 0 when no frame completed for 2 s.
+ * @param[in] strip Strip handle
+ * @param[out] stats Snapshot, see #ARGB_Stats
+ */
+void ARGB_GetStats_Ex(const ARGB_Strip *strip, ARGB_Stats *stats) {
+    const u32_t primask = __get_PRIMASK();
+    __disable_irq(); // Consistent snapshot, DMA callbacks update the counters
+    *stats = strip->stats;
+    const u32_t idle = HAL_GetTick() - strip->fps_t0;
+    __set_PRIMASK(primask);
+    if (idle >= 2000) stats->fps = 0;
+}
+
+/**
+ * @brief Zero counters of the default strip
+ */
+void ARGB_ResetStats(void) {
+    ARGB_ResetStats_Ex(&ARGB_DefaultStrip);
+}
+
+/**
+ * @brief Zero counters of a strip, a new FPS window starts now
+ * @param[in] strip Strip handle
+ */
+void ARGB_ResetStats_Ex(ARGB_Strip *strip) {
+    const u32_t primask = __get_PRIMASK();
+    __disable_irq();
+    const ARGB_Stats zero = {0};
+    strip->stats = zero;
+    strip->fps_n = 0;
+    strip->fps_t0 = HAL_GetTick();
+    __set_PRIMASK(primask);
+}
+#endif
+
+#if ARGB_USE_TRACE
+/**
+ * @brief Record a trace event, oldest events are overwritten
+ * @note Safe from interrupts. The driver records Show, encode, DMA and pacer render
+ *       events; call it for your own marks (e.g. ARGB_EV_RENDER_BEGIN/END).
+ * @param[in] ev Event kind
+ * @param[in] obj Strip / group the event belongs to
+ * @param[in] arg Event argument
+ */
+void ARGB_Trace(ARGB_TraceEv ev, const void *obj, u16_t arg) {
+    const u32_t primask = __get_PRIMASK();
+    __disable_irq();
+    ARGB_TraceEvent *e = &TRACE_BUF[trace_head++ & (ARGB_TRACE_LEN - 1)];
+    e->t = CYCLES();
+    e->obj = obj;
+    e->arg = arg;
+    e->ev = (u8_t) ev;
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Copy recorded events out of the ring, oldest first
+ * @note Recording goes on. Timestamps are DWT->CYCCNT core clocks;
+ *       extras/trace converts a dump to Chrome trace JSON.
+ * @param[out] out Destination
+ * @param[in] max Entries in out
+ * @return Events copied, the newest ones if more than max are stored
+ */
+u16_t ARGB_TraceRead(ARGB_TraceEvent *out, u16_t max) {
+    const u32_t primask = __get_PRIMASK();
+    __disable_irq(); // Events recorded from ISRs during the copy would tear it
+    const u32_t head = trace_head;
+    u32_t n = head < ARGB_TRACE_LEN ? head : ARGB_TRACE_LEN;
+    if (n > max) n = max;
+    for (u32_t i = 0; i < n; i++)
+        out[i] = TRACE_BUF[(head - n + i) & (ARGB_TRACE_LEN - 1)];
+    __set_PRIMASK(primask);
+    return (u16_t) n;
+}
+
+/**
+ * @brief Drop recorded events
+ */
+void ARGB_TraceClear(void) {
+    const u32_t primask = __get_PRIMASK();
+    __disable_irq();
+    trace_head = 0;
+    __set_PRIMASK(primask);
+}
+#endif
+
+/**
+ * @brief Mark the whole default strip as changed
+ * @note Call after writing RGB_BUF directly
+ * @param none
+ */
+void ARGB_Invalidate(void) {
+    ARGB_Invalidate_Ex(&ARGB_DefaultStrip);
+}
+
+/**
+ * @brief Mark a whole strip as changed
+ * @note ARGB_USE_DITHER: the RGB buffer is taken as the new levels (no fraction),
+ *       so bytes written outside the driver are not overwritten by the next Show
+ * @param[in] strip Strip handle
+ */
+void ARGB_Invalidate_Ex(ARGB_Strip *strip) {
+    const u16_t num_bytes = STRIP_BYTES(strip);
+#if ARGB_USE_DITHER
+    for (u16_t i = 0; i < num_bytes; i++) {
+        strip->dith_buf[i] = (u16_t) (strip->rgb_buf[i] << 8);
+    }
+#endif
+    ARGB_MarkDirty(strip, 0, num_bytes);
+}
+
+/**
+ * @brief Bind a framebuffer to the default strip
+ * @param[in] buf ARGB_FB_BYTES(NUM_PIXELS) bytes in wire order
+ * @return Previously bound buffer (RGB_BUF at start), NULL if buf is NULL
+ */
+u8_t *ARGB_SwapBuffer(u8_t *buf) {
+    return ARGB_SwapBuffer_Ex(&ARGB_DefaultStrip, buf);
+}
+
+/**
+ * @brief Bind a framebuffer to a strip, no pixel is copied
+ * @note Next Show encodes from buf and the Set/Fill functions write into it.
+ *       Streaming mode keeps reading the previous buffer until its frame is
+ *       sent: wait for ARGB_Ready_Ex() before drawing into the returned one.
+ * @note ARGB_USE_DITHER: buf is loaded into the 8.8 levels, the Set/Fill functions
+ *       write those, and the dithered output of every Show lands in buf.
+ * @param[in] strip Strip handle
+ * @param[in] buf ARGB_FB_BYTES(num_pixels) bytes in wire order
+ * @return Previously bound buffer, NULL if buf is NULL
+ */
+u8_t *ARGB_SwapBuffer_Ex(ARGB_Strip *strip, u8_t *buf) {
+    if (buf == NULL) return NULL;
+    u8_t *prev = (u8_t *) strip->rgb_buf;
+    strip->rgb_buf = buf;      // single word store
+    ARGB_Invalidate_Ex(strip); // drawn outside the driver, send it whole
+    return prev;
+}
+
+/**
+ * @brief Update strip - fills entire PWM buffer and starts single DMA transfer
+ * @note In streaming mode only the first two halves are filled here
+ * @param none
+ * @return #ARGB_STATE enum
+ */
+ARGB_STATE ARGB_Show(void) {
+    return ARGB_Show_Ex(&ARGB_DefaultStrip);
+}
+
+/**
+ * @brief Update a strip - re-encodes changed bytes and starts DMA transfer
+ * @note With ARGB_SKIP_UNCHANGED unchanged frames are not sent at all
+ * @note During a transfer the frame is queued and started from the DMA ISR (ARGB_USE_QUEUE)
+ * @param[in] strip Strip handle
+ * @return #ARGB_STATE enum
+ */
+ARGB_STATE ARGB_Show_Ex(ARGB_Strip *strip) {
+    TRACE(ARGB_EV_SHOW, strip, STRIP_BYTES(strip));
+    return ARGB_Transmit(strip, STRIP_BYTES(strip));
+}
+
+/**
+ * @brief Update strip up to the last changed pixel
+ * @param none
+ * @return #ARGB_STATE enum
+ */
+ARGB_STATE ARGB_ShowPrefix(void) {
+    return ARGB_ShowPrefix_Ex(&ARGB_DefaultStrip);
+}
+
+/**
+ * @brief Update a strip up to the last changed pixel
+ * @note LEDs past the prefix get no data and keep their latched colour,
+ *       wire time shrinks to the prefix + reset period
+ * @param[in] strip Strip handle
+ * @return #ARGB_STATE enum
+ */
+ARGB_STATE ARGB_ShowPrefix_Ex(ARGB_Strip *strip) {
+    u16_t end = strip->dirty_hi; // Always on a pixel boundary
+    if (strip->dirty_lo >= end) end = STRIP_BYTES(strip);
+    TRACE(ARGB_EV_SHOW, strip, end);
+    return ARGB_Transmit(strip, end);
+}
+
+/**
+ * @addtogroup Private_entities
+ * @{ */
+
+/**
+ * @brief Private method for sending the first `end` RGB bytes of a strip + reset period
+ * @param[in] strip Strip handle
+ * @param[in] end RGB bytes to send, on a pixel boundary
+ * @return #ARGB_STATE enum
+ */
+static ARGB_STATE ARGB_Transmit(ARGB_Strip *strip, u16_t end) {
+    if (strip->htim == NULL) return ARGB_PARAM_ERR;
+#if ARGB_SKIP_UNCHANGED
+    if (strip->dirty_lo >= strip->dirty_hi && !DITHER_PENDING(strip))
+        return ARGB_OK; // Strip already shows this frame
+#endif
+#if ARGB_USE_DITHER && !ARGB_USE_STREAMING
+    ARGB_Dither(strip, end); // Frame on the wire is encoded already, rgb_buf is free
+#endif
+
+#if ARGB_USE_QUEUE
+    if (ARGB_Enqueue(strip, end)) return ARGB_OK; // Sent by the completion ISR
+#endif
+    // Check if DMA is ready
+    if (strip->state == ARGB_BUSY || strip->hdma->State != HAL_DMA_STATE_READY) {
+#if ARGB_USE_STATS
+        strip->stats.busy++;
+#endif
+        return ARGB_BUSY;
+    }
+    return ARGB_Send(strip, end);
+}
+
+/**
+ * @brief Private method for starting a frame encoded from the RGB buffer of the strip
+ * @param[in] strip Strip handle, idle
+ * @param[in] end RGB bytes to send, on a pixel boundary
+ * @return #ARGB_STATE enum
+ */
+static ARGB_STATE ARGB_Send(ARGB_Strip *strip, u16_t end) {
+#if ARGB_USE_DITHER && ARGB_USE_STREAMING
+    ARGB_Dither(strip, end); // The stream reads rgb_buf until the frame ends
+#endif
+    u16_t lo, hi;
+    ARGB_TakeDirty(strip, end, &lo, &hi);
+#if ARGB_USE_DITHER && ARGB_SKIP_UNCHANGED
+    if (lo >= hi) return ARGB_OK; // Dithered output did not change
+#endif
+    return ARGB_Start(strip, end, strip->rgb_buf, lo, hi);
+}
+
+/**
+ * @brief Private method for taking the changed bytes of a frame
+ * @note Bytes past a prefix stay dirty, the LEDs behind it did not get them
+ * @param[in] strip Strip handle
+ * @param[in] end RGB bytes of the frame
+ * @param[out] lo First byte to re-encode
+ * @param[out] hi End of bytes to re-encode, empty if <= lo
+ */
+static void ARGB_TakeDirty(ARGB_Strip *strip, u16_t end, u16_t *lo, u16_t *hi) {
+    const u32_t primask = __get_PRIMASK();
+    __disable_irq(); // DMA ISR may give back the bytes of a failed frame
+    *lo = strip->dirty_lo;
+    *hi = strip->dirty_hi;
+    if (*hi > end) {
+        if (*lo < end) strip->dirty_lo = end;
+        *hi = end;
+    } else {
+        strip->dirty_lo = strip->dirty_hi = 0;
+    }
+    __set_PRIMASK(primask);
+}
+
+/**
+ * @brief Private method for encoding a frame and starting its DMA transfer
+ * @note The PWM buffer keeps the last frame, only src[lo, hi) is re-encoded
+ * @param[in] strip Strip handle, idle
+ * @param[in] end RGB bytes to send, on a pixel boundary
+ * @param[in] src RGB bytes of the frame: rgb_buf, or q_buf for a queued frame
+ * @param[in] lo First byte to re-encode
+ * @param[in] hi End of bytes to re-encode
+ * @return #ARGB_STATE enum
+ */
+static ARGB_STATE ARGB_Start(ARGB_Strip *strip, u16_t end, const volatile u8_t *src, u16_t lo, u16_t hi) {
+    TIM_HandleTypeDef* htim = strip->htim;
+    DMA_HandleTypeDef* hdma = strip->hdma;
+#if ARGB_USE_STATS
+    const u32_t t0 = CYCLES();
+#endif
+    TRACE(ARGB_EV_ENCODE_BEGIN, strip, end);
+    strip->state = ARGB_BUSY;
+    
+#if ARGB_USE_STREAMING
+    // Pre-fill both halves, the rest is encoded from the DMA callbacks
+    strip->stream_byte = 0;
+    strip->stream_sent = 0;
+    strip->stream_end = end;
+    strip->stream_src = src; // ARGB_SwapBuffer() during the frame doesn't tear it
+    ARGB_StreamFill(strip, 0);
+    ARGB_StreamFill(strip, PWM_HALF_LEN);
+    const u32_t xfer_len = 2 * PWM_HALF_LEN;
+#else
+    const u16_t num_bytes = STRIP_BYTES(strip);
+    if (strip->rst_at) {
+        // Restore pixel data under the reset period of the last prefix frame
+        const u16_t r_lo = strip->rst_at;
+        const u16_t r_hi = r_lo + RST_BYTES < num_bytes ? r_lo + RST_BYTES : num_bytes;
+        strip->encode(strip, PWM_SLOT(strip, r_lo * 8), &src[r_lo], r_hi - r_lo);
+        strip->rst_at = 0;
+    }
+    if (lo < hi)
+        strip->encode(strip, PWM_SLOT(strip, lo * 8), &src[lo], hi - lo);
+    if (end < num_bytes) {
+        // Prefix: reset period right after the last sent pixel
+        volatile u8_t *rst = (volatile u8_t *) PWM_SLOT(strip, end * 8);
+        for (u16_t i = 0; i < RST_SLOTS * strip->pwm_width; i++) {
+            rst[i] = 0;
+        }
+        strip->rst_at = end;
+    }
+    const u32_t xfer_len = (u32_t) end * 8 + RST_SLOTS;
+#endif
+    
+    // Clear CCR before starting to avoid initial glitch
+    *strip->tim_ccr = 0;
+    htim->Instance->CNT = 0;
+    __HAL_TIM_CLEAR_FLAG(htim, TIM_FLAG_UPDATE | TIM_FLAG_CC1 | TIM_FLAG_CC2 | TIM_FLAG_CC3 | TIM_FLAG_CC4);
+    
+    // Set channel state
+    TIM_CHANNEL_STATE_SET(htim, strip->tim_channel, HAL_TIM_CHANNEL_STATE_BUSY);
+    
+    // Setup callbacks, they find the strip through Parent
+    hdma->Parent = strip;
+    hdma->XferCpltCallback = ARGB_TIM_DMADelayPulseCplt;
+#if ARGB_USE_STREAMING
+    hdma->XferHalfCpltCallback = ARGB_TIM_DMADelayPulseHalfCplt;
+#else
+    hdma->XferHalfCpltCallback = NULL;  // Not needed for NORMAL mode
+#endif
+    hdma->XferErrorCallback = ARGB_TIM_DMAError;
+#if ARGB_USE_STATS
+    strip->stat_t0 = CYCLES();
+    strip->stat_enc = strip->stat_t0 - t0;
+#endif
+    TRACE(ARGB_EV_ENCODE_END, strip, end);
+    TRACE(ARGB_EV_DMA_START, strip, end);
+    
+    // Start DMA for entire buffer
+    if (HAL_DMA_Start_IT(hdma, (u32_t)(uintptr_t)strip->pwm_buf,
+                         (u32_t)(uintptr_t)strip->tim_ccr, xfer_len) != HAL_OK) {
+        strip->state = ARGB_READY;
+        ARGB_MarkDirty(strip, lo, hi); // Frame not sent, keep it pending
+        TIM_CHANNEL_STATE_SET(htim, strip->tim_channel, HAL_TIM_CHANNEL_STATE_READY);
+        return ARGB_PARAM_ERR;
+    }
+    
+    // Enable DMA request from timer
+    __HAL_TIM_ENABLE_DMA(htim, strip->tim_dma_cc);
+    
+    // Enable timer output for advanced timers (TIM1, TIM8)
+    if (IS_TIM_BREAK_INSTANCE(htim->Instance) != RESET)
+        __HAL_TIM_MOE_ENABLE(htim);
+    
+    // Start timer
+    __HAL_TIM_ENABLE(htim);
+    
+    return ARGB_OK;
+}
+
+#if ARGB_USE_QUEUE
+/**
+ * @brief Private method for queueing a frame behind the one on the wire
+ * @note Latest wins, only the longest requested length is kept. The changed bytes are
+ *       copied to q_buf here, so drawing after ARGB_Show() goes into the next frame.
+ *       Streaming has no copy: the queued frame is encoded from rgb_buf when it starts.
+ * @param[in] strip Strip handle
+ * @param[in] end RGB bytes to send
+ * @return 1 if queued, 0 if the strip is idle and the frame can start now
+ */
+static u8_t ARGB_Enqueue(ARGB_Strip *strip, u16_t end) {
+    const u32_t primask = __get_PRIMASK();
+    __disable_irq(); // completion ISR must not slip between the check and the store
+    if (strip->state != ARGB_BUSY) {
+        __set_PRIMASK(primask);
+        return 0;
+    }
+    if (end > strip->pending) strip->pending = end;
+#if ARGB_USE_STATS
+    strip->stats.queued++;
+#endif
+    TRACE(ARGB_EV_QUEUED, strip, end);
+#if ARGB_QUEUE_COPY
+    u16_t lo, hi;
+    ARGB_TakeDirty(strip, end, &lo, &hi);
+    if (lo < hi) {
+        if (strip->q_lo >= strip->q_hi) {
+            strip->q_lo = lo;
+            strip->q_hi = hi;
+        } else {
+            if (lo < strip->q_lo) strip->q_lo = lo;
+            if (hi > strip->q_hi) strip->q_hi = hi;
+        }
+    }
+    const u16_t r_lo = strip->rst_at; // Fixed until the queued frame starts
+    strip->q_copy = 1; // ISR leaves the queued frame to us until the copy is done
+    __set_PRIMASK(primask);
+
+    // Bytes under the reset period of the frame on the wire are restored from the copy too
+    const u16_t num_bytes = STRIP_BYTES(strip);
+    const u16_t r_hi = r_lo + RST_BYTES < num_bytes ? r_lo + RST_BYTES : num_bytes;
+    for (u16_t i = lo; i < hi; i++) strip->q_buf[i] = strip->rgb_buf[i];
+    for (u16_t i = r_lo; r_lo && i < r_hi; i++) strip->q_buf[i] = strip->rgb_buf[i];
+
+    __disable_irq();
+    strip->q_copy = 0;
+    const u8_t ended = strip->state != ARGB_BUSY; // Frame on the wire ended during the copy
+    __set_PRIMASK(primask);
+    if (ended) ARGB_StartQueued(strip);
+#else
+    __set_PRIMASK(primask);
+#endif
+    return 1;
+}
+
+/**
+ * @brief Private method for starting the queued frame, if any, on an idle strip
+ * @param[in] strip Strip handle
+ */
+static void ARGB_StartQueued(ARGB_Strip *strip) {
+    const u16_t end = strip->pending;
+    if (end == 0) return;
+    strip->pending = 0;
+#if ARGB_QUEUE_COPY
+    const u16_t lo = strip->q_lo, hi = strip->q_hi;
+    strip->q_lo = strip->q_hi = 0;
+    ARGB_Start(strip, end, strip->q_buf, lo, hi);
+#else
+    ARGB_Send(strip, end); // Encoded from rgb_buf as it is now
+#endif
+}
+#endif
+
+#if ARGB_USE_DITHER
+/**
+ * @brief Private method for temporal dithering: rgb_buf = 8.8 level + carried fraction
+ * @note Every byte alternates between the two nearest output values, averaging to the
+ *       8.8 level over frames. Marks the range of bytes whose output changed.
+ * @param[in] strip Strip handle
+ * @param[in] end RGB bytes of the frame
+ */
+static void ARGB_Dither(ARGB_Strip *strip, u16_t end) {
+    const u16_t *lvl = strip->dith_buf;
+    u8_t *err = strip->dith_err;
+    volatile u8_t *out = strip->rgb_buf;
+    u16_t lo = end, hi = 0, frac = 0;
+    for (u16_t i = 0; i < end; i++) {
+        const u16_t acc = lvl[i] + err[i]; // <= 0xFF00 + 0xFF
+        const u8_t v = (u8_t) (acc >> 8);
+        err[i] = (u8_t) acc;
+        frac |= lvl[i] & 0xFF;
+        if (v != out[i]) {
+            out[i] = v;
+            if (i < lo) lo = i;
+            hi = i + 1;
+        }
+    }
+    // A prefix leaves the tail unchecked, keep sending until a full frame settles
+    strip->dith_frac = frac != 0 || end < STRIP_BYTES(strip);
+    if (lo < hi) ARGB_MarkDirty(strip, lo, hi);
+}
+#endif
+
+/** @} */ // Private
+
+/**
+ * @brief Bind a parallel group to its bit clock timer, DMA and GPIO port
+ * @param[in] par Parallel group
+ * @param[in] htim Timer handle, its update event paces the DMA; TIM1/TIM8 on F2/F4/F7
+ * @param[in] hdma DMA handle on the timer's update request, WORD memory/peripheral width;
+ *            a DMA2 stream on F2/F4/F7
+ * @param[in] gpio Port, lanes use pins first_pin .. first_pin + lanes - 1
+ * @param[in] first_pin Pin number of lane 0 [0..15]
+ * @param[in] timer_clock_hz Timer input clock
+ * @return #ARGB_STATE enum, ARGB_PARAM_ERR if this DMA cannot reach the GPIO port or a
+ *         frame is longer than one DMA transfer (ARGB_PAR_WORDS() > ARGB_DMA_MAX_XFER)
+ */
+ARGB_STATE ARGB_ParAttach(ARGB_Parallel *par, TIM_HandleTypeDef *htim, DMA_HandleTypeDef *hdma,
+                          GPIO_TypeDef *gpio, u8_t first_pin, u32_t timer_clock_hz) {
+    if (!par || !htim || !hdma || !gpio) return ARGB_PARAM_ERR;
+    if (par->lanes == 0 || first_pin + par->lanes > ARGB_PAR_MAX_LANES) return ARGB_PARAM_ERR;
+    if (hdma->Init.MemDataAlignment != DMA_MDATAALIGN_WORD) return ARGB_PARAM_ERR; // BSRR is 32-bit
+    if (ARGB_PAR_WORDS(par->num_pixels) * sizeof(u32_t) > par->bsrr_size) return ARGB_PARAM_ERR;
+    if (ARGB_PAR_WORDS(par->num_pixels) > ARGB_DMA_MAX_XFER) return ARGB_PARAM_ERR;
+#if defined(DMA_SxCR_EN)
+    // Stream DMA: DMA1 has no path to the AHB1 GPIO ports, DMA2 takes update requests from TIM1/TIM8 only
+    if ((u32_t) (uintptr_t) hdma->Instance < (u32_t) (uintptr_t) DMA2_Stream0) return ARGB_PARAM_ERR;
+#if defined(TIM8)
+    if (htim->Instance != TIM1 && htim->Instance != TIM8) return ARGB_PARAM_ERR;
+#else
+    if (htim->Instance != TIM1) return ARGB_PARAM_ERR;
+#endif
+#endif
+    par->htim = htim;
+    par->hdma = hdma;
+    par->gpio = gpio;
+    par->first_pin = first_pin;
+    par->timer_clock_hz = timer_clock_hz;
+    return ARGB_OK;
+}
+
+/**
+ * @brief Init bit clock timer and the constant part of the BSRR buffer
+ * @note Bit rate is ARGB_LED_DEFAULT.bit_hz, ARGB_PAR_SLOTS timer updates per bit
+ * @param[in] par Parallel group
+ * @return #ARGB_STATE enum
+ */
+ARGB_STATE ARGB_ParInit(ARGB_Parallel *par) {
+    if (par->htim == NULL) return ARGB_PARAM_ERR;
+    TIM_TypeDef *tim_inst = par->htim->Instance;
+    const u32_t slot_hz = ARGB_LED_DEFAULT.bit_hz * ARGB_PAR_SLOTS;
+    tim_inst->PSC = 0;                                              // no prescaler
+    tim_inst->ARR = (uint16_t) (par->timer_clock_hz / slot_hz - 1); // one update per slot
+    tim_inst->EGR = 1;                                              // update registers
+
+    // Every bit: raise all lanes, drop the 0-lanes (filled by ARGB_ParShow), drop the rest.
+    // Idle slots and the reset period are writes of 0 - no pin change.
+    const u32_t pins = ((1UL << par->lanes) - 1) << par->first_pin;
+    const u32_t data_slots = (u32_t) par->num_pixels * ARGB_BYTES_PER_PIXEL * 8 * ARGB_PAR_SLOTS;
+    volatile u32_t *out = par->bsrr_buf;
+    for (u32_t i = 0; i < ARGB_PAR_WORDS(par->num_pixels); i++) out[i] = 0;
+    for (u32_t i = 0; i < data_slots; i += ARGB_PAR_SLOTS) {
+        out[i] = pins;           // set
+        out[i + 2] = pins << 16; // reset
+    }
+    par->state = ARGB_READY;
+    return ARGB_OK;
+}
+
+/**
+ * @brief Fill ALL lanes with (0,0,0)
+ * @param[in] par Parallel group
+ * @note Update strips after that
+ */
+void ARGB_ParClear(ARGB_Parallel *par) {
+    const u32_t len = (u32_t) par->lanes * par->num_pixels * ARGB_BYTES_PER_PIXEL;
+    for (u32_t i = 0; i < len; i++) par->rgb_buf[i] = 0;
+}
+
+/**
+ * @brief Set brightness of all lanes
+ * @param[in] par Parallel group
+ * @param[in] br Brightness [0..255]
+ */
+void ARGB_ParSetBrightness(ARGB_Parallel *par, u8_t br) {
+    par->br = br;
+}
+
+/**
+ * @brief Set LED of one lane with RGB color by index
+ * @param[in] par Parallel group
+ * @param[in] lane Lane (strip) index
+ * @param[in] i LED position
+ * @param[in] r Red component   [0..255]
+ * @param[in] g Green component [0..255]
+ * @param[in] b Blue component  [0..255]
+ */
+void ARGB_ParSetRGB(ARGB_Parallel *par, u8_t lane, u16_t i, u8_t r, u8_t g, u8_t b) {
+    if (lane >= par->lanes || i >= par->num_pixels) return;
+    const u32_t px = ((u32_t) lane * par->num_pixels + i) * ARGB_BYTES_PER_PIXEL;
+    ARGB_PackRGB((u8_t *) &par->rgb_buf[px], ARGB_LED_DEFAULT.order, par->br, r, g, b);
+}
+
+/**
+ * @brief Set LED of one lane with HSV color by index
+ * @param[in] par Parallel group
+ * @param[in] lane Lane (strip) index
+ * @param[in] i LED position
+ * @param[in] hue HUE (color) [0..255]
+ * @param[in] sat Saturation  [0..255]
+ * @param[in] val Value (brightness) [0..255]
+ */
+void ARGB_ParSetHSV(ARGB_Parallel *par, u8_t lane, u16_t i, u8_t hue, u8_t sat, u8_t val) {
+    uint8_t _r, _g, _b;
+    HSV2RGB(hue, sat, val, &_r, &_g, &_b);
+    ARGB_ParSetRGB(par, lane, i, _r, _g, _b);
+}
+
+/**
+ * @brief Set White component of one lane by index
+ * @param[in] par Parallel group
+ * @param[in] lane Lane (strip) index
+ * @param[in] i LED position
+ * @param[in] w White component [0..255]
+ * @note No effect on RGB strips
+ */
+void ARGB_ParSetWhite(ARGB_Parallel *par, u8_t lane, u16_t i, u8_t w) {
+#if ARGB_BYTES_PER_PIXEL < 4
+    (void) par; (void) lane; (void) i; (void) w;
+#else
+    if (lane >= par->lanes || i >= par->num_pixels) return;
+    par->rgb_buf[((u32_t) lane * par->num_pixels + i) * 4 + ARGB_LED_DEFAULT.order[3]] = LEVEL_U8(ARGB_LevelOf(LEVEL_SCALE(par->br), 3, w));
+#endif
+}
+
+/**
+ * @brief Fill ALL LEDs of one lane with RGB color
+ * @param[in] par Parallel group
+ * @param[in] lane Lane (strip) index
+ * @param[in] r Red component   [0..255]
+ * @param[in] g Green component [0..255]
+ * @param[in] b Blue component  [0..255]
+ */
+void ARGB_ParFillRGB(ARGB_Parallel *par, u8_t lane, u8_t r, u8_t g, u8_t b) {
+    for (u16_t i = 0; i < par->num_pixels; i++)
+        ARGB_ParSetRGB(par, lane, i, r, g, b);
+}
+
+/**
+ * @brief Get current DMA status of a parallel group
+ * @param[in] par Parallel group
+ * @return #ARGB_STATE enum
+ */
+ARGB_STATE ARGB_ParReady(const ARGB_Parallel *par) {
+    return par->state;
+}
+
+/**
+ * @brief Update all lanes - transposes pixel data into BSRR words and starts DMA transfer
+ * @param[in] par Parallel group
+ * @return #ARGB_STATE enum
+ */
+ARGB_STATE ARGB_ParShow(ARGB_Parallel *par) {
+    TIM_HandleTypeDef *htim = par->htim;
+    DMA_HandleTypeDef *hdma = par->hdma;
+    if (htim == NULL) return ARGB_PARAM_ERR;
+    TRACE(ARGB_EV_SHOW, par, par->num_pixels);
+    if (par->state == ARGB_BUSY || hdma->State != HAL_DMA_STATE_READY) {
+        return ARGB_BUSY;
+    }
+    par->state = ARGB_BUSY;
+
+    TRACE(ARGB_EV_ENCODE_BEGIN, par, 0);
+    ARGB_ParEncode(par);
+    TRACE(ARGB_EV_ENCODE_END, par, 0);
+
+    htim->Instance->CNT = 0;
+    __HAL_TIM_CLEAR_FLAG(htim, TIM_FLAG_UPDATE);
+
+    hdma->Parent = par;
+    hdma->XferCpltCallback = ARGB_ParDMACplt;
+    hdma->XferHalfCpltCallback = NULL;
+    hdma->XferErrorCallback = ARGB_ParDMAError;
+    TRACE(ARGB_EV_DMA_START, par, par->num_pixels);
+
+    if (HAL_DMA_Start_IT(hdma, (u32_t)(uintptr_t)par->bsrr_buf,
+                         (u32_t)(uintptr_t)&par->gpio->BSRR, ARGB_PAR_WORDS(par->num_pixels)) != HAL_OK) {
+        par->state = ARGB_READY;
+        return ARGB_PARAM_ERR;
+    }
+    __HAL_TIM_ENABLE_DMA(htim, TIM_DMA_UPDATE);
+    __HAL_TIM_ENABLE(htim);
+    return ARGB_OK;
+}
+
+/**
+ * @brief Bind a burst group to its timer and update DMA
+ * @param[in] burst Burst group, strips on CH1..CHn
+ * @param[in] htim Timer handle
+ * @param[in] hdma DMA handle on the timer's update request
+ * @param[in] timer_clock_hz Timer input clock
+ * @return #ARGB_STATE enum, ARGB_PARAM_ERR if the interleaved frame is longer than one
+ *         DMA transfer (ARGB_DMA_MAX_XFER)
+ */
+ARGB_STATE ARGB_BurstAttach(ARGB_Burst *burst, TIM_HandleTypeDef *htim, DMA_HandleTypeDef *hdma,
+                            u32_t timer_clock_hz) {
+    if (!burst || !htim || !hdma) return ARGB_PARAM_ERR;
+    if (burst->channels == 0 || burst->channels > ARGB_BURST_MAX_CH) return ARGB_PARAM_ERR;
+    const u8_t width = ARGB_DMAWidth(hdma);
+    if (ARGB_BURST_SLOTS(burst->num_pixels) * burst->channels * width > burst->pwm_size)
+        return ARGB_PARAM_ERR;
+    if (ARGB_BURST_SLOTS(burst->num_pixels) * burst->channels > ARGB_DMA_MAX_XFER)
+        return ARGB_PARAM_ERR;
+    burst->htim = htim;
+    burst->hdma = hdma;
+    burst->timer_clock_hz = timer_clock_hz;
+    burst->pwm_width = width;
+    return ARGB_OK;
+}
+
+/**
+ * @brief Init timer & prescalers of a burst group, enables CH1..CHn
+ * @param[in] burst Burst group
+ * @return #ARGB_STATE enum
+ */
+ARGB_STATE ARGB_BurstInit(ARGB_Burst *burst) {
+    if (burst->htim == NULL) return ARGB_PARAM_ERR;
+    TIM_TypeDef *tim_inst = burst->htim->Instance;
+    ARGB_SetupTimer(tim_inst, burst->timer_clock_hz, &ARGB_LED_DEFAULT, &burst->pwm_hi, &burst->pwm_lo);
+    // Every update DMA request is a burst of n transfers into CCR1..CCRn
+    tim_inst->DCR = TIM_DMABASE_CCR1 | ((u32_t) (burst->channels - 1) << TIM_DCR_DBL_Pos);
+
+    burst->state = ARGB_READY;
+    for (u8_t c = 0; c < burst->channels; c++)
+        TIM_CCxChannelCmd(tim_inst, TIM_CHANNEL_1 + 4 * c, TIM_CCx_ENABLE); // GPIO to IDLE state
+    HAL_Delay(1);
+    return ARGB_OK;
+}
+
+/**
+ * @brief Fill ALL channels with (0,0,0)
+ * @param[in] burst Burst group
+ * @note Update strips after that
+ */
+void ARGB_BurstClear(ARGB_Burst *burst) {
+    const u32_t len = (u32_t) burst->channels * burst->num_pixels * ARGB_BYTES_PER_PIXEL;
+    for (u32_t i = 0; i < len; i++) burst->rgb_buf[i] = 0;
+}
+
+/**
+ * @brief Set brightness of all channels
+ * @param[in] burst Burst group
+ * @param[in] br Brightness [0..255]
+ */
+void ARGB_BurstSetBrightness(ARGB_Burst *burst, u8_t br) {
+    burst->br = br;
+}
+
+/**
+ * @brief Set LED of one channel with RGB color by index
+ * @param[in] burst Burst group
+ * @param[in] ch Channel index, 0 = CH1
+ * @param[in] i LED position
+ * @param[in] r Red component   [0..255]
+ * @param[in] g Green component [0..255]
+ * @param[in] b Blue component  [0..255]
+ */
+void ARGB_BurstSetRGB(ARGB_Burst *burst, u8_t ch, u16_t i, u8_t r, u8_t g, u8_t b) {
+    if (ch >= burst->channels || i >= burst->num_pixels) return;
+    const u32_t px = ((u32_t) ch * burst->num_pixels + i) * ARGB_BYTES_PER_PIXEL;
+    ARGB_PackRGB((u8_t *) &burst->rgb_buf[px], ARGB_LED_DEFAULT.order, burst->br, r, g, b);
+}
+
+/**
+ * @brief Set LED of one channel with HSV color by index
+ * @param[in] burst Burst group
+ * @param[in] ch Channel index, 0 = CH1
+ * @param[in] i LED position
+ * @param[in] hue HUE (color) [0..255]
+ * @param[in] sat Saturation  [0..255]
+ * @param[in] val Value (brightness) [0..255]
+ */
+void ARGB_BurstSetHSV(ARGB_Burst *burst, u8_t ch, u16_t i, u8_t hue, u8_t sat, u8_t val) {
+    uint8_t _r, _g, _b;
+    HSV2RGB(hue, sat, val, &_r, &_g, &_b);
+    ARGB_BurstSetRGB(burst, ch, i, _r, _g, _b);
+}
+
+/**
+ * @brief Set White component of one channel by index
+ * @param[in] burst Burst group
+ * @param[in] ch Channel index, 0 = CH1
+ * @param[in] i LED position
+ * @param[in] w White component [0..255]
+ * @note No effect on RGB strips
+ */
+void ARGB_BurstSetWhite(ARGB_Burst *burst, u8_t ch, u16_t i, u8_t w) {
+#if ARGB_BYTES_PER_PIXEL < 4
+    (void) burst; (void) ch; (void) i; (void) w;
+#else
+    if (ch >= burst->channels || i >= burst->num_pixels) return;
+    burst->rgb_buf[((u32_t) ch * burst->num_pixels + i) * 4 + ARGB_LED_DEFAULT.order[3]] = LEVEL_U8(ARGB_LevelOf(LEVEL_SCALE(burst->br), 3, w));
+#endif
+}
+
+/**
+ * @brief Fill ALL LEDs of one channel with RGB color
+ * @param[in] burst Burst group
+ * @param[in] ch Channel index, 0 = CH1
+ * @param[in] r Red component   [0..255]
+ * @param[in] g Green component [0..255]
+ * @param[in] b Blue component  [0..255]
+ */
+void ARGB_BurstFillRGB(ARGB_Burst *burst, u8_t ch, u8_t r, u8_t g, u8_t b) {
+    for (u16_t i = 0; i < burst->num_pixels; i++)
+        ARGB_BurstSetRGB(burst, ch, i, r, g, b);
+}
+
+/**
+ * @brief Get current DMA status of a burst group
+ * @param[in] burst Burst group
+ * @return #ARGB_STATE enum
+ */
+ARGB_STATE ARGB_BurstReady(const ARGB_Burst *burst) {
+    return burst->state;
+}
+
+/**
+ * @brief Update all channels - interleaves PWM slots and starts one burst DMA transfer
+ * @param[in] burst Burst group
+ * @return #ARGB_STATE enum
+ */
+ARGB_STATE ARGB_BurstShow(ARGB_Burst *burst) {
+    TIM_HandleTypeDef *htim = burst->htim;
+    DMA_HandleTypeDef *hdma = burst->hdma;
+    if (htim == NULL) return ARGB_PARAM_ERR;
+    TRACE(ARGB_EV_SHOW, burst, burst->num_pixels);
+    if (burst->state == ARGB_BUSY || hdma->State != HAL_DMA_STATE_READY) {
+        return ARGB_BUSY;
+    }
+    burst->state = ARGB_BUSY;
+
+    TRACE(ARGB_EV_ENCODE_BEGIN, burst, 0);
+    ARGB_BurstEncode(burst);
+    TRACE(ARGB_EV_ENCODE_END, burst, 0);
+
+    // Clear CCRs before starting to avoid initial glitch
+    htim->Instance->CCR1 = 0;
+    htim->Instance->CCR2 = 0;
+    htim->Instance->CCR3 = 0;
+    htim->Instance->CCR4 = 0;
+    htim->Instance->CNT = 0;
+    __HAL_TIM_CLEAR_FLAG(htim, TIM_FLAG_UPDATE);
+
+    hdma->Parent = burst;
+    hdma->XferCpltCallback = ARGB_BurstDMACplt;
+    hdma->XferHalfCpltCallback = NULL;
+    hdma->XferErrorCallback = ARGB_BurstDMAError;
+
+    const u32_t xfer_len = ARGB_BURST_SLOTS(burst->num_pixels) * burst->channels;
+    TRACE(ARGB_EV_DMA_START, burst, burst->num_pixels);
+    if (HAL_DMA_Start_IT(hdma, (u32_t)(uintptr_t)burst->pwm_buf,
+                         (u32_t)(uintptr_t)&htim->Instance->DMAR, xfer_len) != HAL_OK) {
+        burst->state = ARGB_READY;
+        return ARGB_PARAM_ERR;
+    }
+    __HAL_TIM_ENABLE_DMA(htim, TIM_DMA_UPDATE);
+    if (IS_TIM_BREAK_INSTANCE(htim->Instance) != RESET)
+        __HAL_TIM_MOE_ENABLE(htim);
+    __HAL_TIM_ENABLE(htim);
+    return ARGB_OK;
+}
+
+/**
+ * @brief DMA transfer errors of a burst group since boot, each one dropped a frame
+ * @param[in] burst Burst group
+ * @return Error count
+ */
+u32_t ARGB_BurstErrors(const ARGB_Burst *burst) {
+    return burst->dma_errors;
+}
+
+/**
+ * @brief Set up fixed-rate pacing of a strip
+ * @note Configure a spare timer to interrupt at fps and call ARGB_PacerTick() from it.
+ *       render runs in that interrupt right after the previous frame is started, so
+ *       a frame is drawn one period ahead of its transmission.
+ * @param[in] pacer Pacer handle
+ * @param[in] strip Strip to send, initialized
+ * @param[in] fps Frame rate the timer is set to
+ * @param[in] render Render hook, NULL - frames are drawn elsewhere
+ * @param[in] ctx Passed to render as is
+ * @param[in] micros Free-running microsecond clock for the stats
+ * @return #ARGB_STATE enum
+ */
+ARGB_STATE ARGB_PacerInit(ARGB_Pacer *pacer, ARGB_Strip *strip, u16_t fps,
+                          ARGB_RenderFn render, void *ctx, u32_t (*micros)(void)) {
+    if (pacer == NULL || strip == NULL || fps == 0 || micros == NULL) return ARGB_PARAM_ERR;
+    pacer->strip = strip;
+    pacer->render = render;
+    pacer->ctx = ctx;
+    pacer->micros = micros;
+    pacer->period_us = 1000000UL / fps;
+    ARGB_PacerResetStats(pacer);
+    return ARGB_OK;
+}
+
+/**
+ * @brief Frame tick, call from the pacing timer interrupt
+ * @note A deadline is missed when the previous frame is still on the wire (it is
+ *       queued behind it, or dropped with ARGB_USE_QUEUE 0) or Show + render take
+ *       longer than a period.
+ * @param[in] pacer Pacer handle
+ */
+void ARGB_PacerTick(ARGB_Pacer *pacer) {
+    const u32_t t0 = pacer->micros();
+    if (pacer->frames) {
+        const u32_t dt = t0 - pacer->last_tick;
+        const u32_t jitter = dt > pacer->period_us ? dt - pacer->period_us : pacer->period_us - dt;
+        pacer->jitter_sum += jitter;
+        if (jitter > pacer->jitter_max) pacer->jitter_max = jitter;
+    }
+    pacer->last_tick = t0;
+    pacer->frames++;
+
+    u8_t late = ARGB_Ready_Ex(pacer->strip) != ARGB_READY;
+    ARGB_Show_Ex(pacer->strip); // Frame rendered during the last period
+    if (pacer->render) {
+        TRACE(ARGB_EV_RENDER_BEGIN, pacer->strip, 0);
+        pacer->render(pacer->strip, pacer->ctx);
+        TRACE(ARGB_EV_RENDER_END, pacer->strip, 0);
+    }
+
+    const u32_t work = pacer->micros() - t0;
+    if (work > pacer->work_max) pacer->work_max = work;
+    if (work > pacer->period_us) late = 1;
+    if (late) pacer->missed++;
+}
+
+/**
+ * @brief Read pacing statistics
+ * @param[in] pacer Pacer handle
+ * @param[out] stats Report, see #ARGB_PacerStats
+ */
+void ARGB_PacerGetStats(const ARGB_Pacer *pacer, ARGB_PacerStats *stats) {
+    const ARGB_Strip *strip = pacer->strip;
+    const u32_t slots = (u32_t) STRIP_BYTES(strip) * 8 + RST_LEN;
+    const u32_t clock_mhz = strip->timer_clock_hz / 1000000UL;
+    const u32_t work = pacer->work_max;
+
+    stats->frames = pacer->frames;
+    stats->missed = pacer->missed;
+    stats->period_us = pacer->period_us;
+    stats->jitter_avg_us = pacer->frames > 1 ? pacer->jitter_sum / (pacer->frames - 1) : 0;
+    stats->jitter_max_us = pacer->jitter_max;
+    stats->work_max_us = work;
+    // Slot = ARR + 1 timer clocks, see ARGB_SetupTimer()
+    stats->wire_us = clock_mhz && strip->htim ? slots * (strip->htim->Instance->ARR + 1) / clock_mhz : 0;
+    stats->headroom_us = (i32_t) pacer->period_us - (i32_t) (work > stats->wire_us ? work : stats->wire_us);
+}
+
+/**
+ * @brief Clear pacing statistics, the next tick starts a new interval
+ * @param[in] pacer Pacer handle
+ */
+void ARGB_PacerResetStats(ARGB_Pacer *pacer) {
+    pacer->frames = 0;
+    pacer->missed = 0;
+    pacer->jitter_sum = 0;
+    pacer->jitter_max = 0;
+    pacer->work_max = 0;
+}
+
+/**
+ * @addtogroup Private_entities
+ * @{ */
+
+/**
+ * @brief Private method for expanding RGB bytes into PWM slots (MSB first)
+ * @note One instance per slot width, selected at runtime by ARGB_SetupEncoder()
+ * @param[in] strip Strip (nibble table / PWM codes)
+ * @param[out] dst PWM buffer position, 8 slots per byte
+ * @param[in] src RGB buffer position
+ * @param[in] count Bytes to encode
+ */
+#if ARGB_USE_LUT_ENCODER
+#define ARGB_DEFINE_ENCODER(name, slot_t, nibble_t, field)                          \
+static void name(const ARGB_Strip *strip, volatile void *dst,                       \
+                 const volatile u8_t *src, u16_t count) {                           \
+    const nibble_t *tab = strip->lut.field;                                         \
+    nibble_t *out = (nibble_t *) dst; /* DMA is idle while encoding */              \
+    while (count--) {                                                               \
+        const u8_t byte_val = *src++;                                               \
+        *out++ = tab[byte_val >> 4];                                                \
+        *out++ = tab[byte_val & 0x0F];                                              \
+    }                                                                               \
+}
+#else
+#define ARGB_DEFINE_ENCODER(name, slot_t, nibble_t, field)                          \
+static void name(const ARGB_Strip *strip, volatile void *dst,                       \
+                 const volatile u8_t *src, u16_t count) {                           \
+    volatile slot_t *out = (volatile slot_t *) dst;                                 \
+    const slot_t hi = strip->pwm_hi, lo = strip->pwm_lo;                            \
+    while (count--) {                                                               \
+        u8_t byte_val = *src++;                                                     \
+        for (u8_t bit = 0; bit < 8; bit++) {                                        \
+            *out++ = (byte_val & 0x80) ? hi : lo;                                   \
+            byte_val <<= 1;                                                         \
+        }                                                                           \
+    }                                                                               \
+}
+#endif
+
+ARGB_DEFINE_ENCODER(ARGB_Encode8, u8_t, ARGB_Nibble8, b)
+ARGB_DEFINE_ENCODER(ARGB_Encode16, u16_t, ARGB_Nibble16, h)
+ARGB_DEFINE_ENCODER(ARGB_Encode32, u32_t, ARGB_Nibble32, w)
+
+/**
+ * @brief Private method for timer period and PWM codes of an LED type
+ * @param[in] tim_inst Timer
+ * @param[in] APBfq Timer input clock
+ * @param[in] led LED type: bit rate, Log.1/Log.0 high time
+ * @param[out] pwm_hi CCR value of Log.1
+ * @param[out] pwm_lo CCR value of Log.0
+ */
+static void ARGB_SetupTimer(TIM_TypeDef *tim_inst, u32_t APBfq, const ARGB_LedType *led,
+                            u8_t *pwm_hi, u8_t *pwm_lo) {
+    /* Auto-calculation! */
+    APBfq /= led->bit_hz;                     // 800 KHz - 1.25us, 400 KHz - 2.5us
+    tim_inst->PSC = 0;                        // no prescaler
+    tim_inst->ARR = (uint16_t) (APBfq - 1);   // set timer period
+    tim_inst->EGR = 1;                        // update registers
+    
+    *pwm_hi = (u8_t) (APBfq * led->t1h_pct / 100) - 1; // e.g. WS2812 Log.1 - 56% - 0.70us
+    *pwm_lo = (u8_t) (APBfq * led->t0h_pct / 100) - 1; // e.g. WS2812 Log.0 - 28% - 0.35us
+}
+
+/**
+ * @brief Private method for applying the LED type of a strip to its timer and buffers
+ * @note Timer period, PWM codes, nibble table and the persistent reset period;
+ *       the whole frame is re-encoded on the next Show
+ * @param[in] strip Strip handle, attached
+ */
+static void ARGB_ApplyLedType(ARGB_Strip *strip) {
+    ARGB_SetupTimer(strip->htim->Instance, strip->timer_clock_hz, strip->led, &strip->pwm_hi, &strip->pwm_lo);
+    ARGB_SetupEncoder(strip);
+#if !ARGB_USE_STREAMING
+    // Reset period (zeros for LOW signal) never changes, PWM_BUF is persistent
+    volatile u8_t *rst = (volatile u8_t *) PWM_SLOT(strip, STRIP_BYTES(strip) * 8);
+    for (u16_t i = 0; i < RST_SLOTS * strip->pwm_width; i++) {
+        rst[i] = 0;
+    }
+    strip->rst_at = 0;
+#endif
+    ARGB_MarkDirty(strip, 0, STRIP_BYTES(strip)); // PWM codes / slot width / pixel size may have changed
+}
+
+/**
+ * @brief Private method for carving an aligned block off the front of an arena
+ * @note Space is checked by the caller
+ * @param[in] arena Arena handle
+ * @param[in] size Bytes
+ * @return Block
+ */
+static void *ARGB_ArenaTake(ARGB_Arena *arena, u32_t size) {
+    void *p = arena->base + arena->used;
+    arena->used += ARENA_ROUND(size);
+    return p;
+}
+
+/**
+ * @brief Private method for getting PWM slot width from DMA memory data size
+ * @param[in] hdma DMA handle
+ * @return Slot width in bytes
+ */
+static u8_t ARGB_DMAWidth(const DMA_HandleTypeDef *hdma) {
+    switch (hdma->Init.MemDataAlignment) {
+        case DMA_MDATAALIGN_WORD: return 4;
+        case DMA_MDATAALIGN_HALFWORD: return 2;
+        default: return 1;
+    }
+}
+
+/**
+ * @brief Select encoder for the slot width and rebuild nibble table from PWM codes
+ * @param[in] strip Strip handle
+ */
+static void ARGB_SetupEncoder(ARGB_Strip *strip) {
+    strip->encode = strip->pwm_width == 4 ? ARGB_Encode32 :
+                    strip->pwm_width == 2 ? ARGB_Encode16 : ARGB_Encode8;
+#if ARGB_USE_LUT_ENCODER
+    for (u8_t n = 0; n < 16; n++) {
+        for (u8_t bit = 0; bit < 4; bit++) {
+            const u8_t val = (n & (0x08 >> bit)) ? strip->pwm_hi : strip->pwm_lo;
+            if (strip->pwm_width == 4) strip->lut.w[n].slot[bit] = val;
+            else if (strip->pwm_width == 2) strip->lut.h[n].slot[bit] = val;
+            else strip->lut.b[n].slot[bit] = val;
+        }
+    }
+#endif
+}
+
+#if ARGB_USE_STREAMING
+/**
+ * @brief Encode next chunk of the strip into one half of the ping-pong buffer
+ * @param[in] strip Strip handle
+ * @param[in] first_slot First slot of the half to refill (0 or PWM_HALF_LEN)
+ * @note Slots past the last pixel are zeroed, they form the reset period
+ */
+static void ARGB_StreamFill(ARGB_Strip *strip, u16_t first_slot) {
+    u16_t count = strip->stream_end - strip->stream_byte;
+    if (count > STREAM_HALF_BYTES) count = STREAM_HALF_BYTES;
+    strip->encode(strip, PWM_SLOT(strip, first_slot), &strip->stream_src[strip->stream_byte], count);
+    strip->stream_byte += count;
+    volatile u8_t *pad = (volatile u8_t *) PWM_SLOT(strip, first_slot + count * 8);
+    for (u16_t i = 0; i < (PWM_HALF_LEN - count * 8) * strip->pwm_width; i++)
+        pad[i] = 0;
+}
+
+/**
+ * @brief Halves to transmit: all data bits of the frame followed by at least RST_SLOTS zero slots
+ * @param[in] strip Strip handle
+ */
+static inline u16_t ARGB_StreamHalves(const ARGB_Strip *strip) {
+    return ((u32_t) strip->stream_end * 8 + RST_SLOTS + PWM_HALF_LEN - 1) / PWM_HALF_LEN;
+}
+
+/**
+ * @brief Refill a half from the DMA callbacks, time counted as encode cycles
+ * @param[in] strip Strip handle
+ * @param[in] first_slot First slot of the half to refill (0 or PWM_HALF_LEN)
+ */
+static inline void ARGB_Refill(ARGB_Strip *strip, u16_t first_slot) {
+    TRACE(ARGB_EV_ENCODE_BEGIN, strip, strip->stream_byte);
+#if ARGB_USE_STATS
+    const u32_t t0 = CYCLES();
+    ARGB_StreamFill(strip, first_slot);
+    strip->stat_enc += CYCLES() - t0;
+#else
+    ARGB_StreamFill(strip, first_slot);
+#endif
+    TRACE(ARGB_EV_ENCODE_END, strip, strip->stream_byte);
+}
+#endif
+
+/**
+ * @brief Private method for expanding RGB bytes of all channels into interleaved PWM slots
+ * @note One instance per slot width, slot s of channel c lands at s * channels + c
+ * @param[in] burst Burst group
+ */
+#define ARGB_DEFINE_BURST_ENCODER(name, slot_t)                                     \
+static void name(ARGB_Burst *burst) {                                               \
+    const u8_t ch = burst->channels;                                                \
+    const u16_t num_bytes = burst->num_pixels * ARGB_BYTES_PER_PIXEL;               \
+    const slot_t code[2] = { burst->pwm_lo, burst->pwm_hi };                        \
+    const u8_t *src = (const u8_t *) burst->rgb_buf; /* DMA is idle */              \
+    slot_t *out = (slot_t *) burst->pwm_buf;                                        \
+    for (u16_t k = 0; k < num_bytes; k++) {                                         \
+        for (u8_t c = 0; c < ch; c++) {                                             \
+            const u8_t byte_val = src[(u32_t) c * num_bytes + k];                   \
+            slot_t *dst = out + c;                                                  \
+            for (u8_t bit = 0; bit < 8; bit++, dst += ch)                           \
+                *dst = code[(byte_val >> (7 - bit)) & 1];                           \
+        }                                                                           \
+        out += 8 * ch;                                                              \
+    }                                                                               \
+    for (u32_t i = 0; i < (u32_t) ARGB_RST_LEN * ch; i++)                           \
+        out[i] = 0; /* reset period */                                              \
+}
+
+ARGB_DEFINE_BURST_ENCODER(ARGB_BurstEncode8, u8_t)
+ARGB_DEFINE_BURST_ENCODER(ARGB_BurstEncode16, u16_t)
+ARGB_DEFINE_BURST_ENCODER(ARGB_BurstEncode32, u32_t)
+
+/**
+ * @brief Private method for running the burst encoder of the slot width
+ * @param[in] burst Burst group
+ */
+static void ARGB_BurstEncode(ARGB_Burst *burst) {
+    if (burst->pwm_width == 4) ARGB_BurstEncode32(burst);
+    else if (burst->pwm_width == 2) ARGB_BurstEncode16(burst);
+    else ARGB_BurstEncode8(burst);
+}
+
+/**
+ * @brief Private method for 8x8 bit matrix transpose, word at a time
+ * @param[in] x Bytes of lanes 7..4 (lane 7 in the top byte)
+ * @param[in] y Bytes of lanes 3..0
+ * @param[out] mask Lane masks, mask[j] bit l = bit (7 - j) of lane l
+ */
+static inline void ARGB_Transpose8(u32_t x, u32_t y, u8_t mask[8]) {
+    u32_t t;
+    t = (x ^ (x >> 7)) & 0x00AA00AAUL;  x ^= t ^ (t << 7);
+    t = (y ^ (y >> 7)) & 0x00AA00AAUL;  y ^= t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCCUL; x ^= t ^ (t << 14);
+    t = (y ^ (y >> 14)) & 0x0000CCCCUL; y ^= t ^ (t << 14);
+    t = (x & 0xF0F0F0F0UL) | ((y >> 4) & 0x0F0F0F0FUL);
+    y = ((x << 4) & 0xF0F0F0F0UL) | (y & 0x0F0F0F0FUL);
+    mask[0] = t >> 24; mask[1] = t >> 16; mask[2] = t >> 8; mask[3] = t;
+    mask[4] = y >> 24; mask[5] = y >> 16; mask[6] = y >> 8; mask[7] = y;
+}
+
+/**
+ * @brief Private method for filling the data slot of every bit in the BSRR buffer
+ * @note Set/reset-all slots are constant, written once by ARGB_ParInit()
+ * @param[in] par Parallel group
+ */
+static void ARGB_ParEncode(ARGB_Parallel *par) {
+    const u16_t num_bytes = par->num_pixels * ARGB_BYTES_PER_PIXEL;
+    const u32_t lanes_mask = (1UL << par->lanes) - 1;
+    const u8_t shift = 16 + par->first_pin; // reset half of BSRR
+    const u8_t *src = (const u8_t *) par->rgb_buf; // DMA is idle while encoding
+    u32_t *out = (u32_t *) par->bsrr_buf + 1;
+    u8_t lane[ARGB_PAR_MAX_LANES] = {0,};
+
+    for (u16_t k = 0; k < num_bytes; k++) {
+        for (u8_t l = 0; l < par->lanes; l++)
+            lane[l] = src[(u32_t) l * num_bytes + k];
+        u8_t lo[8], hi[8];
+        ARGB_Transpose8((u32_t) lane[7] << 24 | (u32_t) lane[6] << 16 | (u32_t) lane[5] << 8 | lane[4],
+                        (u32_t) lane[3] << 24 | (u32_t) lane[2] << 16 | (u32_t) lane[1] << 8 | lane[0], lo);
+        if (par->lanes > 8) {
+            ARGB_Transpose8((u32_t) lane[15] << 24 | (u32_t) lane[14] << 16 | (u32_t) lane[13] << 8 | lane[12],
+                            (u32_t) lane[11] << 24 | (u32_t) lane[10] << 16 | (u32_t) lane[9] << 8 | lane[8], hi);
+        } else {
+            for (u8_t j = 0; j < 8; j++) hi[j] = 0;
+        }
+        for (u8_t j = 0; j < 8; j++) {
+            const u32_t ones = (u32_t) hi[j] << 8 | lo[j];
+            *out = (~ones & lanes_mask) << shift; // 0-bit lanes end their pulse here
+            out += ARGB_PAR_SLOTS;
+        }
+    }
+}
+
+/// x / 255 without division, exact for x < 65535
+#define DIV255(x) ((u8_t) (((u32_t) (x) + 1 + ((u32_t) (x) >> 8)) >> 8))
+
+/**
+ * @brief Convert color in HSV to RGB, fixed point
+ * @note Same sectors as HSV2RGB_Float(), within 1 LSB of it; multiplies and shifts only
+ * @param[in] hue HUE (color) [0..255]
+ * @param[in] sat Saturation  [0..255]
+ * @param[in] val Value (brightness) [0..255]
+ * @param[out] _r Pointer to RED component value
+ * @param[out] _g Pointer to GREEN component value
+ * @param[out] _b Pointer to BLUE component value
+ */
+static inline void HSV2RGB_Int(u8_t hue, u8_t sat, u8_t val, u8_t *_r, u8_t *_g, u8_t *_b) {
+    if (sat == 0) { // if white color
+        *_r = *_g = *_b = val;
+        return;
+    }
+    const u16_t h6 = (u16_t) hue * 6;             // sector + fraction, 1/255 units
+    const u8_t reg = DIV255(h6);                  // sector 0..6
+    const u8_t rem = (u8_t) (h6 - reg * 255);     // fraction [0..254]
+    const u8_t p = DIV255((u16_t) val * (255 - sat));
+    const u8_t q = DIV255((u16_t) val * (255 - DIV255((u16_t) sat * rem)));
+    const u8_t t = DIV255((u16_t) val * (255 - DIV255((u16_t) sat * (255 - rem))));
+
+    switch (reg) {
+        case 1: *_r = q, *_g = val, *_b = p; break;
+        case 2: *_r = p, *_g = val, *_b = t; break;
+        case 3: *_r = p, *_g = q, *_b = val; break;
+        case 4: *_r = t, *_g = p, *_b = val; break;
+        case 5: *_r = val, *_g = p, *_b = q; break;
+        default: *_r = val, *_g = t, *_b = p; break; // 0, and 6 for hue 255
+    }
+}
+
+/**
+ * @brief Convert color in HSV to RGB, float (original version)
+ * @param[in] hue HUE (color) [0..255]
+ * @param[in] sat Saturation  [0..255]
+ * @param[in] val Value (brightness) [0..255]
+ * @param[out] _r Pointer to RED component value
+ * @param[out] _g Pointer to GREEN component value
+ * @param[out] _b Pointer to BLUE component value
+ */
+static inline void HSV2RGB_Float(u8_t hue, u8_t sat, u8_t val, u8_t *_r, u8_t *_g, u8_t *_b) {
+    if (sat == 0) { // if white color
+        *_r = *_g = *_b = val;
+        return;
+    }
+    // Float is smoother but check for FPU (Floating point unit) in your MCU
+    // Otherwise it will take longer time in the code
     // FPU is in: F3/L3 and greater
     // Src: https://github.com/Inseckto/HSV-to-RGB
     float h = (float)hue / 255;
@@ -522,54 +2312,217 @@ static void HSV2RGB(u8_t hue, u8_t sat, u8_t val, u8_t *_r, u8_t *_g, u8_t *_b)
 }
 
 /**
-  * @brief  TIM DMA Delay Pulse complete callback (NORMAL mode).
-  *         Called when entire PWM buffer has been transmitted.
-  * @param  hdma pointer to DMA handle.
+  * @brief  TIM DMA Delay Pulse complete callback.
+  *         NORMAL mode: called when entire PWM buffer has been transmitted.
+  *         Streaming mode: refills the second half of the ping-pong buffer.
+  * @param  hdma pointer to DMA handle, Parent is the strip.
   * @retval None
   */
 static void ARGB_TIM_DMADelayPulseCplt(DMA_HandleTypeDef *hdma) {
-    TIM_HandleTypeDef *htim = (TIM_HandleTypeDef *) hdma->Parent;
-    
-    // Get channel info
-    u32_t tim_ch, tim_dma_cc;
-    if (s_htim != NULL) {
-        tim_ch = s_tim_channel;
-        tim_dma_cc = s_tim_dma_cc;
-    } else {
-#ifndef ARGB_USE_RUNTIME_BINDING
-        tim_ch = TIM_CH;
-        tim_dma_cc = (TIM_CH == TIM_CHANNEL_1) ? TIM_DMA_CC1 :
-                     (TIM_CH == TIM_CHANNEL_2) ? TIM_DMA_CC2 :
-                     (TIM_CH == TIM_CHANNEL_3) ? TIM_DMA_CC3 : TIM_DMA_CC4;
-#else
-        return;  // No valid configuration
+    ARGB_Strip *strip = (ARGB_Strip *) hdma->Parent;
+    TRACE(ARGB_EV_DMA_CPLT, strip, 0);
+#if ARGB_USE_STREAMING
+    // Second half sent - refill it while the first one is on the wire
+    if (++strip->stream_sent < ARGB_StreamHalves(strip)) {
+        ARGB_Refill(strip, PWM_HALF_LEN);
+        return;
+    }
 #endif
+    ARGB_DataSent(strip);
+}
+
+#if ARGB_USE_STREAMING
+/**
+  * @brief  TIM DMA Delay Pulse half complete callback (streaming mode).
+  *         Refills the first half of the ping-pong buffer.
+  * @param  hdma pointer to DMA handle, Parent is the strip.
+  * @retval None
+  */
+static void ARGB_TIM_DMADelayPulseHalfCplt(DMA_HandleTypeDef *hdma) {
+    ARGB_Strip *strip = (ARGB_Strip *) hdma->Parent;
+    TRACE(ARGB_EV_DMA_HALF, strip, 0);
+    if (++strip->stream_sent < ARGB_StreamHalves(strip)) {
+        ARGB_Refill(strip, 0);
+        return;
     }
+    ARGB_DataSent(strip);
+}
+#endif
+
+/**
+  * @brief  TIM DMA error callback. Stops the transfer and releases the strip.
+  * @param  hdma pointer to DMA handle, Parent is the strip.
+  * @retval None
+  */
+static void ARGB_TIM_DMAError(DMA_HandleTypeDef *hdma) {
+    ARGB_Strip *strip = (ARGB_Strip *) hdma->Parent;
+#if ARGB_USE_QUEUE
+    strip->pending = 0; // Its bytes go back to the dirty range, the next Show sends them
+#if ARGB_QUEUE_COPY
+    if (strip->q_lo < strip->q_hi) ARGB_MarkDirty(strip, strip->q_lo, strip->q_hi);
+    strip->q_lo = strip->q_hi = 0;
+#endif
+#endif
+#if ARGB_USE_STATS
+    strip->stats.dma_errors++;
+#endif
+    ARGB_StopTransfer(strip);
+}
+
+/**
+  * @brief  Stop DMA requests and timer after the reset period has been sent
+  * @param  strip Strip handle.
+  * @retval None
+  */
+static void ARGB_StopTransfer(ARGB_Strip *strip) {
+    TIM_HandleTypeDef *htim = strip->htim;
     
     // Stop DMA and timer
-    __HAL_TIM_DISABLE_DMA(htim, tim_dma_cc);
+    __HAL_TIM_DISABLE_DMA(htim, strip->tim_dma_cc);
+#if ARGB_USE_STREAMING
+    if (strip->hdma->State == HAL_DMA_STATE_BUSY)
+        HAL_DMA_Abort(strip->hdma);  // Circular stream never completes by itself
+#endif
     
     if (IS_TIM_BREAK_INSTANCE(htim->Instance) != RESET)
         __HAL_TIM_MOE_DISABLE(htim);
     __HAL_TIM_DISABLE(htim);
     
     // Set channel state to ready
-    TIM_CHANNEL_STATE_SET(htim, tim_ch, HAL_TIM_CHANNEL_STATE_READY);
+    TIM_CHANNEL_STATE_SET(htim, strip->tim_channel, HAL_TIM_CHANNEL_STATE_READY);
     
     // Clear active channel
     htim->Channel = HAL_TIM_ACTIVE_CHANNEL_CLEARED;
     
     // Signal completion
-    ARGB_LOC_ST = ARGB_READY;
+    strip->state = ARGB_READY;
 }
 
 /**
-  * @brief  TIM DMA Delay Pulse half complete callback (unused in NORMAL mode).
-  * @param  hdma pointer to DMA handle.
+  * @brief  Last DMA slot of a frame sent. Zero slots sent the reset period already,
+  *         or (ARGB_USE_HW_LATCH) the timer holds the line LOW for it.
+  * @note   The last request came from the compare match of the last data bit:
+  *         its pulse is over, CCR holds the trailing zero slot.
+  * @param  strip Strip handle
   * @retval None
   */
-static void ARGB_TIM_DMADelayPulseHalfCplt(DMA_HandleTypeDef *hdma) {
-    (void)hdma;  // Unused in NORMAL mode
+static void ARGB_DataSent(ARGB_Strip *strip) {
+#if ARGB_USE_HW_LATCH
+    TIM_HandleTypeDef *htim = strip->htim;
+    __HAL_TIM_DISABLE_DMA(htim, strip->tim_dma_cc);
+#if ARGB_USE_STREAMING
+    HAL_DMA_Abort(strip->hdma);
+#endif
+    *strip->tim_ccr = 0;
+    htim->Instance->PSC = RST_LEN - 1;   // One timer period = RST_LEN slots
+    htim->Instance->EGR = TIM_EGR_UG;    // Restart the period now, LOW from here
+    __HAL_TIM_CLEAR_FLAG(htim, TIM_FLAG_UPDATE);
+    __HAL_TIM_ENABLE_IT(htim, TIM_IT_UPDATE); // ARGB_TIM_IRQHandler_Ex() ends the frame
+#else
+    ARGB_FrameDone(strip);
+#endif
+}
+
+/**
+  * @brief  Last slot of a frame sent: release the strip, start the queued frame if any,
+  *         notify the application.
+  * @param  strip Strip handle
+  * @retval None
+  */
+static void ARGB_FrameDone(ARGB_Strip *strip) {
+#if ARGB_USE_STATS
+    ARGB_Stats *st = &strip->stats;
+    const u32_t wire = CYCLES() - strip->stat_t0;
+    st->frames++;
+    st->wire_cycles = wire;
+    if (wire > st->wire_max) st->wire_max = wire;
+    st->encode_cycles = strip->stat_enc;
+    if (strip->stat_enc > st->encode_max) st->encode_max = strip->stat_enc;
+    // FPS over whole seconds of HAL ticks
+    const u32_t now = HAL_GetTick();
+    strip->fps_n++;
+    if (now - strip->fps_t0 >= 1000) {
+        st->fps = (u16_t) ((u32_t) strip->fps_n * 1000 / (now - strip->fps_t0));
+        strip->fps_n = 0;
+        strip->fps_t0 = now;
+    }
+#endif
+    ARGB_StopTransfer(strip);
+    TRACE(ARGB_EV_FRAME_DONE, strip, 0);
+#if ARGB_USE_QUEUE
+    // Newest frame requested during this one, ARGB_Show() starts it if still copying it
+    if (!QUEUE_COPYING(strip)) ARGB_StartQueued(strip);
+#endif
+    if (strip->on_done) strip->on_done(strip, strip->done_ctx);
+}
+
+/**
+  * @brief  Parallel group DMA complete callback, reset period already sent.
+  * @param  hdma pointer to DMA handle, Parent is the group.
+  * @retval None
+  */
+static void ARGB_ParDMACplt(DMA_HandleTypeDef *hdma) {
+    TRACE(ARGB_EV_DMA_CPLT, hdma->Parent, 0);
+    ARGB_ParStop((ARGB_Parallel *) hdma->Parent);
+    TRACE(ARGB_EV_FRAME_DONE, hdma->Parent, 0);
+}
+
+/**
+  * @brief  Parallel group DMA error callback.
+  * @param  hdma pointer to DMA handle, Parent is the group.
+  * @retval None
+  */
+static void ARGB_ParDMAError(DMA_HandleTypeDef *hdma) {
+    ARGB_Parallel *par = (ARGB_Parallel *) hdma->Parent;
+    par->gpio->BSRR = (((1UL << par->lanes) - 1) << par->first_pin) << 16; // leave lanes LOW
+    ARGB_ParStop(par);
+}
+
+/**
+  * @brief  Stop update DMA requests and the bit clock timer
+  * @param  par Parallel group.
+  * @retval None
+  */
+static void ARGB_ParStop(ARGB_Parallel *par) {
+    __HAL_TIM_DISABLE_DMA(par->htim, TIM_DMA_UPDATE);
+    __HAL_TIM_DISABLE(par->htim);
+    par->state = ARGB_READY;
+}
+
+/**
+  * @brief  Burst group DMA complete callback, stops the timer after the frame.
+  * @param  hdma pointer to DMA handle, Parent is the group.
+  * @retval None
+  */
+static void ARGB_BurstDMACplt(DMA_HandleTypeDef *hdma) {
+    TRACE(ARGB_EV_DMA_CPLT, hdma->Parent, 0);
+    ARGB_BurstStop((ARGB_Burst *) hdma->Parent);
+    TRACE(ARGB_EV_FRAME_DONE, hdma->Parent, 0);
+}
+
+/**
+  * @brief  Burst group DMA error callback, counts the dropped frame and releases the group.
+  * @param  hdma pointer to DMA handle, Parent is the group.
+  * @retval None
+  */
+static void ARGB_BurstDMAError(DMA_HandleTypeDef *hdma) {
+    ARGB_Burst *burst = (ARGB_Burst *) hdma->Parent;
+    burst->dma_errors++;
+    ARGB_BurstStop(burst);
+}
+
+/**
+  * @brief  Stop update DMA requests and the timer of a burst group
+  * @param  burst Burst group.
+  * @retval None
+  */
+static void ARGB_BurstStop(ARGB_Burst *burst) {
+    TIM_HandleTypeDef *htim = burst->htim;
+    __HAL_TIM_DISABLE_DMA(htim, TIM_DMA_UPDATE);
+    if (IS_TIM_BREAK_INSTANCE(htim->Instance) != RESET)
+        __HAL_TIM_MOE_DISABLE(htim);
+    __HAL_TIM_DISABLE(htim);
+    burst->state = ARGB_READY;
 }
 
 /** @} */ // Private
@@ -581,6 +2534,9 @@ static void ARGB_TIM_DMADelayPulseHalfCplt(DMA_HandleTypeDef *hdma) {
 #error INCORRECT LED TYPE
 #warning Set it from list in ARGB.h string 29
 #endif
+#if ARGB_MAX_BYTES_PER_PIXEL < ARGB_BYTES_PER_PIXEL || ARGB_MAX_BYTES_PER_PIXEL > 4
+#error ARGB_MAX_BYTES_PER_PIXEL must hold the selected family (3 or 4)
+#endif
 
 // Check channel (only for legacy CubeMX mode)
 #ifndef ARGB_USE_RUNTIME_BINDING
@@ -590,6 +2546,6 @@ static void ARGB_TIM_DMADelayPulseHalfCplt(DMA_HandleTypeDef *hdma) {
 #endif
 
 // Check DMA Size
-#if !(defined(DMA_SIZE_BYTE) | defined(DMA_SIZE_HWORD) | defined(DMA_SIZE_WORD))
-#error Wrong DMA Size! Fix it in ARGB.h string 42
+#if (defined(DMA_SIZE_BYTE) + defined(DMA_SIZE_HWORD) + defined(DMA_SIZE_WORD)) > 1
+#error Wrong DMA Size! Define one of DMA_SIZE_BYTE / DMA_SIZE_HWORD / DMA_SIZE_WORD at most
 #endif
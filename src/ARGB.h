@@ -13,6 +13,9 @@
  * 
  * @note Arduino/STM32duino port by DashyFox:
  *       - Added ARGB_Attach() for runtime TIM/DMA binding
+ *
+ * @note Several strips: ARGB_STRIP_DEF() + the _Ex functions. Strips that
+ *       must transmit at the same time need separate timers.
  */
 
 #ifndef ARGB_H_
@@ -37,13 +40,59 @@
 // WS2811F — RGB, 800kHz;
 // WS2812  — GRB, 800kHz;
 // SK6812  — RGBW, 800kHz
+// The family is the LED type of every strip until ARGB_SetLedType_Ex(),
+// parallel and burst groups always use it.
 
 #ifndef NUM_PIXELS
-#define NUM_PIXELS 5 ///< Pixel quantity (define before including)
+#define NUM_PIXELS 5 ///< Pixel quantity (define before including), 0 - no default strip (arena strips only)
 #endif
 
 #ifndef USE_GAMMA_CORRECTION
-#define USE_GAMMA_CORRECTION 0 ///< Gamma-correction (0/1)
+#define USE_GAMMA_CORRECTION 0 ///< Gamma-correction (0/1): perceptual curve (2.2) + G/B white balance
+#endif
+
+#ifndef ARGB_USE_INT_HSV
+#define ARGB_USE_INT_HSV 1 ///< Fixed-point HSV->RGB (no FPU needed), 0 - original float version (0/1)
+#endif
+
+#ifndef ARGB_USE_LUT_ENCODER
+#define ARGB_USE_LUT_ENCODER 1 ///< Expand bytes via nibble->PWM table instead of bit loop (0/1)
+#endif
+
+#ifndef ARGB_USE_DITHER
+#define ARGB_USE_DITHER 0 ///< Keep 8.8 colour per byte, temporal error diffusion in ARGB_Show() (0/1)
+#endif
+
+#ifndef ARGB_USE_QUEUE
+#define ARGB_USE_QUEUE 0 ///< Opt-in: ARGB_Show() during a transfer queues the frame (latest wins), sent from the DMA ISR (0/1)
+#endif
+
+#ifndef ARGB_USE_STATS
+#define ARGB_USE_STATS 1 ///< Frame/error counters and DWT cycle timing per strip, see ARGB_GetStats() (0/1)
+#endif
+
+#ifndef ARGB_USE_TRACE
+#define ARGB_USE_TRACE 0 ///< Timestamped event ring (Show, encode, DMA, render), see ARGB_TraceRead() (0/1)
+#endif
+
+#ifndef ARGB_TRACE_LEN
+#define ARGB_TRACE_LEN 128 ///< Trace ring entries, power of 2
+#endif
+
+#ifndef ARGB_USE_HW_LATCH
+#define ARGB_USE_HW_LATCH 0 ///< Reset period timed by the strip's timer, not zero slots; needs ARGB_TIM_IRQHandler() (0/1)
+#endif
+
+#ifndef ARGB_SKIP_UNCHANGED
+#define ARGB_SKIP_UNCHANGED 0 ///< Opt-in: ARGB_Show() returns at once if no pixel changed since the last frame (0/1)
+#endif
+
+// Streaming mode: circular DMA over a small ping-pong buffer (DMA must be DMA_CIRCULAR)
+#ifndef ARGB_USE_STREAMING
+#define ARGB_USE_STREAMING 0 ///< Stream pixels through a two-half buffer (0/1)
+#endif
+#ifndef ARGB_STREAM_PIXELS
+#define ARGB_STREAM_PIXELS 4 ///< Pixels encoded into each half of the streaming buffer
 #endif
 
 // Legacy CubeMX settings (not used with ARGB_Auto.h)
@@ -56,10 +105,96 @@
 #ifndef DMA_HANDLE
 #define DMA_HANDLE hdma_tim2_ch2_ch4  ///< DMA Channel
 #endif
-#if !defined(DMA_SIZE_BYTE) && !defined(DMA_SIZE_HWORD) && !defined(DMA_SIZE_WORD)
-#define DMA_SIZE_WORD     ///< DMA Data Width (default WORD for 32-bit timers)
+// DMA_SIZE_BYTE / DMA_SIZE_HWORD / DMA_SIZE_WORD - optional, PWM slot width reserved by
+// default (ARGB_PWM_WIDTH); without it the narrowest width valid for every timer is used
+
+/// @}
+
+/**
+ * @addtogroup Strip_sizes
+ * @brief Buffer sizes for strip storage
+ * @{
+ */
+#ifdef SK6812
+#define ARGB_BYTES_PER_PIXEL 4  ///< RGBW
+#else
+#define ARGB_BYTES_PER_PIXEL 3  ///< RGB
+#endif
+#ifndef ARGB_MAX_BYTES_PER_PIXEL
+#define ARGB_MAX_BYTES_PER_PIXEL ARGB_BYTES_PER_PIXEL ///< Reserved per strip pixel, 4 lets RGB builds switch strips to RGBW
+#endif
+
+/**
+ * @brief PWM slot width reserved by ARGB_STRIP_DEF() and the default strip, bytes
+ * @note On stream DMA (F2/F4/F7) the default is 4 so TIM2/TIM5 strips work, and saves no
+ *       RAM there. The 2x saving for 16-bit timers is opt-in:
+ *       define DMA_SIZE_HWORD for the build, or size single strips with ARGB_STRIP_DEF_W(),
+ *       ARGB_ArenaStrip(..., width) and ARGB_PwmWidth(), with HALFWORD DMA memory width.
+ */
+#if defined(DMA_SIZE_BYTE)
+#define ARGB_PWM_WIDTH 1
+#elif defined(DMA_SIZE_HWORD)
+#define ARGB_PWM_WIDTH 2
+#elif defined(DMA_SIZE_WORD)
+#define ARGB_PWM_WIDTH 4
+#elif defined(DMA_SxCR_EN)
+#define ARGB_PWM_WIDTH 4        ///< Stream DMA (F2/F4/F7): MSIZE = PSIZE, TIM2/TIM5 take WORD
+#else
+#define ARGB_PWM_WIDTH 1        ///< Channel DMA: a memory byte is zero-extended into any CCR
 #endif
 
+#define ARGB_RST_LEN 60         ///< Reset period (60+ bits of LOW = 75us @ 800kHz)
+#if ARGB_USE_HW_LATCH
+#define ARGB_RST_SLOTS 1        ///< One zero slot ends the data, the timer holds LOW for the reset
+#else
+#define ARGB_RST_SLOTS ARGB_RST_LEN ///< Zero slots sent after the data
+#endif
+
+/// Longest DMA transfer, elements: NDTR/CNDTR are 16 bits. A strip frame (slots + reset) must fit
+#define ARGB_DMA_MAX_XFER 65535UL
+
+/// PWM slots of one strip: whole frame + reset, or two stream halves
+#if ARGB_USE_STREAMING
+#define ARGB_PWM_SLOTS(pixels) (2 * ARGB_STREAM_PIXELS * ARGB_MAX_BYTES_PER_PIXEL * 8)
+#else
+#define ARGB_PWM_SLOTS(pixels) ((pixels) * ARGB_MAX_BYTES_PER_PIXEL * 8 + ARGB_RST_SLOTS)
+#endif
+#define ARGB_PWM_BYTES_W(pixels, width) (ARGB_PWM_SLOTS(pixels) * (width)) ///< PWM storage for slots of width bytes
+#define ARGB_PWM_BYTES(pixels) ARGB_PWM_BYTES_W(pixels, ARGB_PWM_WIDTH)
+#define ARGB_FB_BYTES(pixels) ((pixels) * ARGB_MAX_BYTES_PER_PIXEL) ///< Framebuffer for ARGB_SwapBuffer(), wire order
+
+/// A queued frame is copied at ARGB_Show() and encoded from the copy; streaming encodes the live buffer
+#define ARGB_QUEUE_COPY (ARGB_USE_QUEUE && !ARGB_USE_STREAMING)
+/// @}
+
+/**
+ * @addtogroup Parallel_sizes
+ * @brief Parallel (GPIO BSRR) output: one DMA stream drives up to 16 pins of a port
+ * @{
+ */
+#ifndef ARGB_PAR_SLOTS
+#ifdef WS2812
+#define ARGB_PAR_SLOTS 3        ///< BSRR writes per bit: T0H = 1 slot, T1H = 2 slots
+#else
+#define ARGB_PAR_SLOTS 4        ///< SK6812/WS2811 need a shorter T1H relative to the period
+#endif
+#endif
+#define ARGB_PAR_MAX_LANES 16   ///< One GPIO port
+
+/// BSRR words of one parallel group: every bit + reset period
+#define ARGB_PAR_WORDS(pixels) \
+    (((u32_t) (pixels) * ARGB_BYTES_PER_PIXEL * 8 + ARGB_RST_LEN) * ARGB_PAR_SLOTS)
+/// @}
+
+/**
+ * @addtogroup Burst_sizes
+ * @brief Timer DMA burst: CCR1..CCRn of one timer fed from one interleaved buffer
+ * @{
+ */
+#define ARGB_BURST_MAX_CH 4     ///< CCR1..CCR4
+
+/// PWM slots of every channel of a burst group: whole frame + reset
+#define ARGB_BURST_SLOTS(pixels) ((u32_t) (pixels) * ARGB_BYTES_PER_PIXEL * 8 + ARGB_RST_LEN)
 /// @}
 
 /**
@@ -80,10 +215,331 @@ typedef enum ARGB_STATE {
     ARGB_PARAM_ERR = 3, ///< Error in input parameters
 } ARGB_STATE;
 
+/// 4 PWM slots of one nibble, copied as a single struct
+typedef struct { u8_t slot[4]; } ARGB_Nibble8;
+typedef struct { u16_t slot[4]; } ARGB_Nibble16;
+typedef struct { u32_t slot[4]; } ARGB_Nibble32;
+
+#if ARGB_USE_DITHER
+typedef u16_t ARGB_Level; ///< Output level, 8.8 fixed point
+#else
+typedef u8_t ARGB_Level;  ///< Output level
+#endif
+
+typedef struct ARGB_Strip ARGB_Strip;
+
+/// PWM encoder for one slot width
+typedef void (*ARGB_EncodeFn)(const ARGB_Strip *strip, volatile void *dst,
+                              const volatile u8_t *src, u16_t count);
+
+/**
+ * @brief Strip counters, see ARGB_GetStats_Ex()
+ * @note Cycles are DWT->CYCCNT core clocks (0 on cores without DWT, e.g. Cortex-M0)
+ */
+typedef struct ARGB_Stats {
+    u32_t frames;               ///< Frames sent to the end of the reset period
+    u32_t busy;                 ///< Shows rejected with ARGB_BUSY
+    u32_t queued;               ///< Shows queued behind a transfer (ARGB_USE_QUEUE)
+    u32_t dma_errors;           ///< DMA transfer errors
+    u32_t encode_cycles;        ///< CPU cycles spent encoding the last frame (+ streaming refills)
+    u32_t encode_max;           ///< Largest encode_cycles
+    u32_t wire_cycles;          ///< Cycles from DMA start to the end of the reset period, last frame
+    u32_t wire_max;             ///< Largest wire_cycles
+    u16_t fps;                  ///< Frames completed per second, last whole second
+} ARGB_Stats;
+
+/// Trace event kinds, see ARGB_TraceRead()
+typedef enum ARGB_TraceEv {
+    ARGB_EV_SHOW = 0,           ///< Show entry, arg = RGB bytes requested
+    ARGB_EV_QUEUED,             ///< Show queued behind the frame on the wire
+    ARGB_EV_ENCODE_BEGIN,       ///< Encoding starts (Show or streaming refill)
+    ARGB_EV_ENCODE_END,         ///< Encoding done
+    ARGB_EV_DMA_START,          ///< HAL_DMA_Start_IT(), arg = RGB bytes in the frame
+    ARGB_EV_DMA_HALF,           ///< Half transfer callback entry
+    ARGB_EV_DMA_CPLT,           ///< Transfer complete callback entry
+    ARGB_EV_FRAME_DONE,         ///< Reset period sent, strip released
+    ARGB_EV_RENDER_BEGIN,       ///< Application render hook starts
+    ARGB_EV_RENDER_END,         ///< Render hook returns
+    ARGB_EV_COUNT
+} ARGB_TraceEv;
+
+/// One trace record
+typedef struct ARGB_TraceEvent {
+    u32_t t;                    ///< DWT->CYCCNT at the event
+    const void *obj;            ///< Strip / parallel / burst group
+    u16_t arg;                  ///< Event argument
+    u8_t ev;                    ///< #ARGB_TraceEv
+} ARGB_TraceEvent;
+
+/**
+ * @brief LED chip: bit rate, high time of 0/1 bits, pixel size and colour order
+ * @note Strips switch types with ARGB_SetLedType_Ex(). The encoders only see the
+ *       PWM codes and nibble table built from it, the bit loop is the same for all.
+ */
+typedef struct ARGB_LedType {
+    u32_t bit_hz;               ///< Bit rate, 800000 or 400000
+    u8_t t1h_pct;               ///< Log.1 high time, % of the bit period
+    u8_t t0h_pct;               ///< Log.0 high time, % of the bit period
+    u8_t bpp;                   ///< Bytes per pixel, 3 (RGB) or 4 (RGBW)
+    u8_t order[4];              ///< Wire byte of R, G, B, W within a pixel
+} ARGB_LedType;
+
+extern const ARGB_LedType ARGB_LED_WS2811S; ///< RGB, 400 kHz
+extern const ARGB_LedType ARGB_LED_WS2811F; ///< RGB, 800 kHz
+extern const ARGB_LedType ARGB_LED_WS2812;  ///< GRB, 800 kHz
+extern const ARGB_LedType ARGB_LED_SK6812;  ///< RGBW, 800 kHz
+
+/// LED type of the family selected at build time
+#if defined(SK6812)
+#define ARGB_LED_DEFAULT ARGB_LED_SK6812
+#elif defined(WS2811S)
+#define ARGB_LED_DEFAULT ARGB_LED_WS2811S
+#elif defined(WS2811F)
+#define ARGB_LED_DEFAULT ARGB_LED_WS2811F
+#else
+#define ARGB_LED_DEFAULT ARGB_LED_WS2812
+#endif
+
+/// Frame complete callback, runs in the DMA interrupt once the reset period is sent
+typedef void (*ARGB_DoneFn)(ARGB_Strip *strip, void *ctx);
+
+/**
+ * @brief One LED strip: buffers, timer/DMA binding, timing and state
+ * @note Define with ARGB_STRIP_DEF(), fields are private to the driver
+ */
+struct ARGB_Strip {
+    volatile u8_t *rgb_buf;     ///< Colour bytes in wire order
+    volatile void *pwm_buf;     ///< PWM slots for DMA
+    u32_t pwm_size;             ///< PWM buffer size, bytes
+    u32_t rgb_size;             ///< RGB buffer size, bytes (dither buffers hold as many entries)
+    u16_t num_pixels;           ///< Strip length
+    const ARGB_LedType *led;    ///< LED chip, ARGB_LED_DEFAULT until ARGB_SetLedType_Ex()
+#if ARGB_USE_DITHER
+    u16_t *dith_buf;            ///< 8.8 colour per RGB byte, rgb_buf is derived in ARGB_Show()
+    u8_t *dith_err;             ///< Fraction carried to the next frame, per RGB byte
+#endif
+#if ARGB_QUEUE_COPY
+    volatile u8_t *q_buf;       ///< Queued frame as it was at ARGB_Show(), rgb_size bytes
+#endif
+    volatile u8_t br;           ///< Global brightness
+
+    TIM_HandleTypeDef *htim;    ///< Bound timer
+    DMA_HandleTypeDef *hdma;    ///< Bound DMA, hdma->Parent points back to the strip
+    u32_t tim_channel;          ///< TIM_CHANNEL_x
+    volatile u32_t *tim_ccr;    ///< CCR register of the channel
+    u32_t tim_dma_cc;           ///< TIM_DMA_CCx
+    u32_t timer_clock_hz;       ///< Timer input clock
+
+    u8_t pwm_hi;                ///< PWM Code HI Log.1 period
+    u8_t pwm_lo;                ///< PWM Code LO Log.1 period
+    u8_t pwm_width;             ///< Bytes per PWM slot (1/2/4), from DMA memory width
+    ARGB_EncodeFn encode;       ///< Encoder for pwm_width
+#if ARGB_USE_LUT_ENCODER
+    union {
+        ARGB_Nibble8 b[16];
+        ARGB_Nibble16 h[16];
+        ARGB_Nibble32 w[16];
+    } lut;                      ///< Nibble -> PWM slots
+#endif
+
+    volatile ARGB_STATE state;  ///< Buffer send status
+#if ARGB_USE_QUEUE
+    volatile u16_t pending;     ///< RGB bytes of the frame queued behind the current one, 0 - none
+#endif
+#if ARGB_QUEUE_COPY
+    u16_t q_lo;                 ///< First q_buf byte the queued frame re-encodes
+    u16_t q_hi;                 ///< End of re-encoded q_buf bytes, empty if <= q_lo
+    volatile u8_t q_copy;       ///< ARGB_Show() is copying into q_buf, the ISR leaves the frame to it
+#endif
+    ARGB_DoneFn on_done;        ///< Frame complete callback, NULL - none
+    void *done_ctx;             ///< Argument of on_done
+#if ARGB_USE_STATS
+    ARGB_Stats stats;           ///< Counters
+    u32_t stat_t0;              ///< Cycle counter at the DMA start of the current frame
+    u32_t stat_enc;             ///< Encode cycles of the current frame so far
+    u32_t fps_t0;               ///< HAL tick at the start of the FPS window
+    u16_t fps_n;                ///< Frames completed in the FPS window
+#endif
+    volatile u16_t dirty_lo;    ///< First RGB byte changed since last Show
+    volatile u16_t dirty_hi;    ///< End of changed bytes, empty if <= dirty_lo
+#if ARGB_USE_DITHER
+    u8_t dith_frac;             ///< Last frame had fractional levels, output still moving
+#endif
+#if ARGB_USE_STREAMING
+    volatile u16_t stream_byte; ///< Next RGB byte to be encoded
+    volatile u16_t stream_sent; ///< Halves already transmitted
+    u16_t stream_end;           ///< RGB bytes in the current frame
+    const volatile u8_t *stream_src; ///< RGB buffer of the current frame
+#else
+    u16_t rst_at;               ///< Byte whose PWM slots hold a prefix reset period, 0 - none
+#endif
+};
+
+/**
+ * @brief Define a strip with static storage for `pixels` LEDs and PWM slots of `width` bytes
+ * @note width must cover the DMA memory width it is attached with (1/2/4), e.g. 2 for a
+ *       16-bit timer on a stream DMA. Attach it with ARGB_Attach_Ex(&name, ...) and
+ *       ARGB_Init_Ex(&name)
+ */
+#define ARGB_STRIP_DEF_W(name, pixels, width)                                          \
+    static volatile u8_t name##_rgb[(pixels) * ARGB_MAX_BYTES_PER_PIXEL];              \
+    static volatile u32_t name##_pwm[(ARGB_PWM_BYTES_W(pixels, width) + 3) / 4];       \
+    ARGB_STRIP_DITH_DEF(name, (pixels) * ARGB_MAX_BYTES_PER_PIXEL)                     \
+    ARGB_STRIP_QUEUE_DEF(name, (pixels) * ARGB_MAX_BYTES_PER_PIXEL)                    \
+    ARGB_Strip name = { .rgb_buf = name##_rgb, .pwm_buf = name##_pwm,                  \
+                        .pwm_size = sizeof(name##_pwm), .rgb_size = sizeof(name##_rgb), \
+                        .num_pixels = (pixels), .led = &ARGB_LED_DEFAULT,              \
+                        ARGB_STRIP_DITH_INIT(name) ARGB_STRIP_QUEUE_INIT(name) .br = 255 }
+
+/// Optional per-strip buffers of ARGB_STRIP_DEF_W(), in ARGB_Strip field order
+#if ARGB_USE_DITHER
+#define ARGB_STRIP_DITH_DEF(name, bytes) static u16_t name##_dith[bytes]; static u8_t name##_err[bytes];
+#define ARGB_STRIP_DITH_INIT(name) .dith_buf = name##_dith, .dith_err = name##_err,
+#else
+#define ARGB_STRIP_DITH_DEF(name, bytes)
+#define ARGB_STRIP_DITH_INIT(name)
+#endif
+#if ARGB_QUEUE_COPY
+#define ARGB_STRIP_QUEUE_DEF(name, bytes) static volatile u8_t name##_q[bytes];
+#define ARGB_STRIP_QUEUE_INIT(name) .q_buf = name##_q,
+#else
+#define ARGB_STRIP_QUEUE_DEF(name, bytes)
+#define ARGB_STRIP_QUEUE_INIT(name)
+#endif
+
+/// Define a strip with PWM slots of ARGB_PWM_WIDTH bytes, see ARGB_STRIP_DEF_W()
+#define ARGB_STRIP_DEF(name, pixels) ARGB_STRIP_DEF_W(name, pixels, ARGB_PWM_WIDTH)
+
+/**
+ * @brief Boot-time memory for strips sized at runtime, see ARGB_ArenaStrip()
+ * @note Carved front to back and never freed: no malloc, no fragmentation.
+ *       Must be DMA-reachable RAM (not CCM on F4).
+ */
+typedef struct ARGB_Arena {
+    u8_t *base;                 ///< Aligned start of the memory
+    u32_t size;                 ///< Usable bytes from base
+    u32_t used;                 ///< Bytes carved so far, padding included
+} ARGB_Arena;
+
+/**
+ * @brief Up to 16 strips on consecutive pins of one GPIO port, sent by a single DMA stream
+ * @note Timer update requests DMA writes to GPIO BSRR, ARGB_PAR_SLOTS per bit.
+ *       Define with ARGB_PAR_DEF(), fields are private to the driver.
+ * @note All lanes use the build-time family: bit rate of ARGB_LED_DEFAULT, ARGB_PAR_SLOTS
+ *       and ARGB_BYTES_PER_PIXEL. Runtime LED types (ARGB_SetLedType_Ex()) apply to
+ *       ARGB_Strip only.
+ * @note F2/F4/F7: only DMA2 can write GPIO, so the timer must be TIM1 or TIM8 on a DMA2
+ *       stream; ARGB_ParAttach() rejects other pairings.
+ * @note A frame is one DMA transfer: ARGB_PAR_WORDS(pixels) <= ARGB_DMA_MAX_XFER, 907 LEDs
+ *       per lane for WS2812.
+ */
+typedef struct ARGB_Parallel {
+    volatile u8_t *rgb_buf;     ///< Colour bytes, lane l starts at l * num_pixels * ARGB_BYTES_PER_PIXEL
+    volatile u32_t *bsrr_buf;   ///< BSRR words for DMA
+    u32_t bsrr_size;            ///< BSRR buffer size, bytes
+    u16_t num_pixels;           ///< Pixels per lane
+    u8_t lanes;                 ///< Lanes in use [1..16]
+    volatile u8_t br;           ///< Global brightness
+
+    TIM_HandleTypeDef *htim;    ///< Bit clock timer
+    DMA_HandleTypeDef *hdma;    ///< DMA on the timer update request, WORD memory width
+    GPIO_TypeDef *gpio;         ///< Port of the lanes, pins are plain push-pull outputs
+    u8_t first_pin;             ///< Pin number of lane 0
+    u32_t timer_clock_hz;       ///< Timer input clock
+
+    volatile ARGB_STATE state;  ///< Buffer send status
+} ARGB_Parallel;
+
+/**
+ * @brief Define a parallel group of `n_lanes` strips with `pixels` LEDs each
+ * @note Attach it with ARGB_ParAttach(&name, ...) and ARGB_ParInit(&name)
+ */
+#define ARGB_PAR_DEF(name, n_lanes, pixels)                                            \
+    static volatile u8_t name##_rgb[(n_lanes) * (pixels) * ARGB_BYTES_PER_PIXEL];      \
+    static volatile u32_t name##_bsrr[ARGB_PAR_WORDS(pixels)];                         \
+    ARGB_Parallel name = { .rgb_buf = name##_rgb, .bsrr_buf = name##_bsrr,             \
+                           .bsrr_size = sizeof(name##_bsrr), .num_pixels = (pixels),    \
+                           .lanes = (n_lanes), .br = 255 }
+
+/**
+ * @brief Up to 4 strips on CH1..CHn of one timer, sent by a single update DMA in burst mode
+ * @note DMA writes TIMx->DMAR, DCR spreads every n-word burst over CCR1..CCRn.
+ *       Define with ARGB_BURST_DEF(), fields are private to the driver.
+ */
+typedef struct ARGB_Burst {
+    volatile u8_t *rgb_buf;     ///< Colour bytes, channel c starts at c * num_pixels * ARGB_BYTES_PER_PIXEL
+    volatile void *pwm_buf;     ///< PWM slots, CCR1..CCRn interleaved
+    u32_t pwm_size;             ///< PWM buffer size, bytes
+    u16_t num_pixels;           ///< Pixels per channel
+    u8_t channels;              ///< Channels in use [1..4], starting at CH1
+    volatile u8_t br;           ///< Global brightness
+
+    TIM_HandleTypeDef *htim;    ///< Timer of all channels
+    DMA_HandleTypeDef *hdma;    ///< DMA on the timer's update request
+    u32_t timer_clock_hz;       ///< Timer input clock
+
+    u8_t pwm_hi;                ///< PWM Code HI Log.1 period
+    u8_t pwm_lo;                ///< PWM Code LO Log.1 period
+    u8_t pwm_width;             ///< Bytes per PWM slot (1/2/4), from DMA memory width
+
+    volatile u32_t dma_errors;  ///< DMA transfer errors, frame dropped
+    volatile ARGB_STATE state;  ///< Buffer send status
+} ARGB_Burst;
+
+/**
+ * @brief Define a burst group of `n_channels` strips with `pixels` LEDs each
+ * @note Attach it with ARGB_BurstAttach(&name, ...) and ARGB_BurstInit(&name)
+ */
+#define ARGB_BURST_DEF(name, n_channels, pixels)                                       \
+    static volatile u8_t name##_rgb[(n_channels) * (pixels) * ARGB_BYTES_PER_PIXEL];   \
+    static volatile u32_t name##_pwm[(ARGB_BURST_SLOTS(pixels) * (n_channels) * ARGB_PWM_WIDTH + 3) / 4]; \
+    ARGB_Burst name = { .rgb_buf = name##_rgb, .pwm_buf = name##_pwm,                  \
+                        .pwm_size = sizeof(name##_pwm), .num_pixels = (pixels),         \
+                        .channels = (n_channels), .br = 255 }
+
+/// Render hook of a pacer: draw the next frame into the strip
+typedef void (*ARGB_RenderFn)(ARGB_Strip *strip, void *ctx);
+
+/**
+ * @brief Fixed-rate frame pacing: ARGB_PacerTick() is called from a hardware timer
+ *        interrupt at the frame rate, sends the frame rendered during the last period
+ *        and calls the render hook for the next one
+ * @note Set up with ARGB_PacerInit(), fields are private to the driver
+ */
+typedef struct ARGB_Pacer {
+    ARGB_Strip *strip;          ///< Paced strip
+    ARGB_RenderFn render;       ///< Render hook, NULL - frames are drawn elsewhere
+    void *ctx;                  ///< Argument of render
+    u32_t (*micros)(void);      ///< Free-running microsecond clock (micros(), DWT...)
+    u32_t period_us;            ///< Frame period
+
+    u32_t last_tick;            ///< Clock at the previous tick
+    u32_t frames;               ///< Ticks since the stats were reset
+    u32_t missed;               ///< Frames that missed a deadline
+    u32_t jitter_sum;           ///< Sum of |tick interval - period|
+    u32_t jitter_max;           ///< Largest |tick interval - period|
+    u32_t work_max;             ///< Longest Show + render inside a tick
+} ARGB_Pacer;
+
+/// Pacing report, all times in microseconds
+typedef struct ARGB_PacerStats {
+    u32_t frames;               ///< Ticks since the stats were reset
+    u32_t missed;               ///< Deadlines missed: strip still sending at the tick, or tick work over a period
+    u32_t period_us;            ///< Configured frame period
+    u32_t jitter_avg_us;        ///< Mean deviation of the tick interval from the period
+    u32_t jitter_max_us;        ///< Worst deviation of the tick interval
+    u32_t work_max_us;          ///< Longest Show + render inside a tick
+    u32_t wire_us;              ///< Time on the wire of a whole frame + reset
+    i32_t headroom_us;          ///< period - max(work, wire), negative - the rate can't be held
+} ARGB_PacerStats;
+
+extern ARGB_Strip ARGB_DefaultStrip; ///< Strip behind the non-_Ex API (NUM_PIXELS)
+
 void ARGB_Init(void);   // Initialization
 void ARGB_Clear(void);  // Clear strip
 
 void ARGB_SetBrightness(u8_t br); // Set global brightness
+ARGB_STATE ARGB_SetLedType(const ARGB_LedType *led); // Select LED chip at runtime
 
 void ARGB_SetRGB(u16_t i, u8_t r, u8_t g, u8_t b);  // Set single LED by RGB
 void ARGB_SetHSV(u16_t i, u8_t hue, u8_t sat, u8_t val); // Set single LED by HSV
@@ -92,9 +548,30 @@ void ARGB_SetWhite(u16_t i, u8_t w); // Set white component in LED (RGBW)
 void ARGB_FillRGB(u8_t r, u8_t g, u8_t b); // Fill all strip with RGB color
 void ARGB_FillHSV(u8_t hue, u8_t sat, u8_t val); // Fill all strip with HSV color
 void ARGB_FillWhite(u8_t w); // Fill all strip's white component (RGBW)
+void ARGB_FillRainbow(u16_t start, u16_t count, u8_t hue0, u8_t dhue, u8_t sat, u8_t val); // Hue ramp over a range
+
+void ARGB_WritePixels(u16_t offset, const u8_t *rgb, u16_t count); // Load LEDs from packed R,G,B
+void ARGB_WritePixelsRGBW(u16_t offset, const u8_t *rgbw, u16_t count); // Load LEDs from packed R,G,B,W
+void ARGB_WritePixels32(u16_t offset, const u32_t *wrgb, u16_t count); // Load LEDs from 0xWWRRGGBB words
 
 ARGB_STATE ARGB_Ready(void); // Get DMA Ready state
+#if ARGB_USE_HW_LATCH
+void ARGB_TIM_IRQHandler(void); // Call from the strip timer's IRQ handler, ends the reset period
+#endif
+#if ARGB_USE_TRACE
+void ARGB_Trace(ARGB_TraceEv ev, const void *obj, u16_t arg); // Record an event (e.g. own render begin/end)
+u16_t ARGB_TraceRead(ARGB_TraceEvent *out, u16_t max); // Copy recorded events, oldest first
+void ARGB_TraceClear(void); // Drop recorded events
+#endif
+void ARGB_OnComplete(ARGB_DoneFn fn, void *ctx); // Call fn from the DMA ISR after every frame
+#if ARGB_USE_STATS
+void ARGB_GetStats(ARGB_Stats *stats); // Snapshot of frame/error/timing counters
+void ARGB_ResetStats(void); // Zero the counters
+#endif
 ARGB_STATE ARGB_Show(void); // Push data to the strip
+ARGB_STATE ARGB_ShowPrefix(void); // Push pixels up to the last changed one
+void ARGB_Invalidate(void); // Re-encode and resend whole strip on next Show
+u8_t *ARGB_SwapBuffer(u8_t *buf); // Bind a user framebuffer, returns the previous one
 
 /**
  * @brief  Runtime binding to TIM/DMA (Arduino/STM32duino friendly)
@@ -105,6 +582,82 @@ ARGB_STATE ARGB_Attach(TIM_HandleTypeDef* htim,
                        DMA_HandleTypeDef* hdma,
                        u32_t timer_clock_hz);
 
+// Multi-instance API, the functions above act on ARGB_DefaultStrip
+ARGB_STATE ARGB_Attach_Ex(ARGB_Strip *strip, TIM_HandleTypeDef* htim, u32_t tim_channel,
+                          DMA_HandleTypeDef* hdma, u32_t timer_clock_hz);
+ARGB_STATE ARGB_Init_Ex(ARGB_Strip *strip);
+void ARGB_Clear_Ex(ARGB_Strip *strip);
+
+void ARGB_SetBrightness_Ex(ARGB_Strip *strip, u8_t br);
+ARGB_STATE ARGB_SetLedType_Ex(ARGB_Strip *strip, const ARGB_LedType *led);
+
+void ARGB_SetRGB_Ex(ARGB_Strip *strip, u16_t i, u8_t r, u8_t g, u8_t b);
+void ARGB_SetHSV_Ex(ARGB_Strip *strip, u16_t i, u8_t hue, u8_t sat, u8_t val);
+void ARGB_SetWhite_Ex(ARGB_Strip *strip, u16_t i, u8_t w);
+
+void ARGB_FillRGB_Ex(ARGB_Strip *strip, u8_t r, u8_t g, u8_t b);
+void ARGB_FillHSV_Ex(ARGB_Strip *strip, u8_t hue, u8_t sat, u8_t val);
+void ARGB_FillWhite_Ex(ARGB_Strip *strip, u8_t w);
+void ARGB_FillRainbow_Ex(ARGB_Strip *strip, u16_t start, u16_t count,
+                         u8_t hue0, u8_t dhue, u8_t sat, u8_t val);
+
+void ARGB_WritePixels_Ex(ARGB_Strip *strip, u16_t offset, const u8_t *rgb, u16_t count);
+void ARGB_WritePixelsRGBW_Ex(ARGB_Strip *strip, u16_t offset, const u8_t *rgbw, u16_t count);
+void ARGB_WritePixels32_Ex(ARGB_Strip *strip, u16_t offset, const u32_t *wrgb, u16_t count);
+
+ARGB_STATE ARGB_Ready_Ex(const ARGB_Strip *strip);
+#if ARGB_USE_HW_LATCH
+void ARGB_TIM_IRQHandler_Ex(ARGB_Strip *strip);
+#endif
+void ARGB_OnComplete_Ex(ARGB_Strip *strip, ARGB_DoneFn fn, void *ctx);
+#if ARGB_USE_STATS
+void ARGB_GetStats_Ex(const ARGB_Strip *strip, ARGB_Stats *stats);
+void ARGB_ResetStats_Ex(ARGB_Strip *strip);
+#endif
+ARGB_STATE ARGB_Show_Ex(ARGB_Strip *strip);
+ARGB_STATE ARGB_ShowPrefix_Ex(ARGB_Strip *strip);
+void ARGB_Invalidate_Ex(ARGB_Strip *strip);
+u8_t *ARGB_SwapBuffer_Ex(ARGB_Strip *strip, u8_t *buf);
+
+// Strips sized at boot, buffers carved from an application arena
+void ARGB_ArenaInit(ARGB_Arena *arena, void *mem, u32_t size);
+u32_t ARGB_ArenaStripBytes(u16_t pixels, const ARGB_LedType *led, u8_t pwm_width);
+ARGB_Strip *ARGB_ArenaStrip(ARGB_Arena *arena, u16_t pixels, const ARGB_LedType *led, u8_t pwm_width);
+
+// Parallel output, lane = strip index inside the group
+ARGB_STATE ARGB_ParAttach(ARGB_Parallel *par, TIM_HandleTypeDef *htim, DMA_HandleTypeDef *hdma,
+                          GPIO_TypeDef *gpio, u8_t first_pin, u32_t timer_clock_hz);
+ARGB_STATE ARGB_ParInit(ARGB_Parallel *par);
+void ARGB_ParClear(ARGB_Parallel *par);
+void ARGB_ParSetBrightness(ARGB_Parallel *par, u8_t br);
+void ARGB_ParSetRGB(ARGB_Parallel *par, u8_t lane, u16_t i, u8_t r, u8_t g, u8_t b);
+void ARGB_ParSetHSV(ARGB_Parallel *par, u8_t lane, u16_t i, u8_t hue, u8_t sat, u8_t val);
+void ARGB_ParSetWhite(ARGB_Parallel *par, u8_t lane, u16_t i, u8_t w);
+void ARGB_ParFillRGB(ARGB_Parallel *par, u8_t lane, u8_t r, u8_t g, u8_t b);
+ARGB_STATE ARGB_ParReady(const ARGB_Parallel *par);
+ARGB_STATE ARGB_ParShow(ARGB_Parallel *par);
+
+// Timer DMA burst, ch = 0..3 for CH1..CH4
+ARGB_STATE ARGB_BurstAttach(ARGB_Burst *burst, TIM_HandleTypeDef *htim, DMA_HandleTypeDef *hdma,
+                            u32_t timer_clock_hz);
+ARGB_STATE ARGB_BurstInit(ARGB_Burst *burst);
+void ARGB_BurstClear(ARGB_Burst *burst);
+void ARGB_BurstSetBrightness(ARGB_Burst *burst, u8_t br);
+void ARGB_BurstSetRGB(ARGB_Burst *burst, u8_t ch, u16_t i, u8_t r, u8_t g, u8_t b);
+void ARGB_BurstSetHSV(ARGB_Burst *burst, u8_t ch, u16_t i, u8_t hue, u8_t sat, u8_t val);
+void ARGB_BurstSetWhite(ARGB_Burst *burst, u8_t ch, u16_t i, u8_t w);
+void ARGB_BurstFillRGB(ARGB_Burst *burst, u8_t ch, u8_t r, u8_t g, u8_t b);
+ARGB_STATE ARGB_BurstReady(const ARGB_Burst *burst);
+ARGB_STATE ARGB_BurstShow(ARGB_Burst *burst);
+u32_t ARGB_BurstErrors(const ARGB_Burst *burst);
+
+// Frame pacing, ARGB_PacerTick() from a timer ISR at fps
+ARGB_STATE ARGB_PacerInit(ARGB_Pacer *pacer, ARGB_Strip *strip, u16_t fps,
+                          ARGB_RenderFn render, void *ctx, u32_t (*micros)(void));
+void ARGB_PacerTick(ARGB_Pacer *pacer);
+void ARGB_PacerGetStats(const ARGB_Pacer *pacer, ARGB_PacerStats *stats);
+void ARGB_PacerResetStats(ARGB_Pacer *pacer);
+
 #ifdef __cplusplus
 }
 #endif
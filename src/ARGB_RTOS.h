@@ -0,0 +1,76 @@
+/**
+ *******************************************
+ * @file    ARGB_RTOS.h
+ * @brief   FreeRTOS glue for ARGB frame complete callbacks
+ *******************************************
+ *
+ * @note Optional, not pulled in by ARGB.h. Needs FreeRTOS on the include path
+ *       (STM32FreeRTOS library on Arduino, CubeMX FreeRTOS middleware).
+ *
+ * @note Binary semaphore:
+ *       sem = xSemaphoreCreateBinary();
+ *       ARGB_OnComplete(ARGB_RTOS_GiveSemaphore, sem);
+ *       render task: ARGB_RTOS_WaitReady(&ARGB_DefaultStrip, sem, portMAX_DELAY);
+ *
+ * @note Task notification (no extra object, one waiting task):
+ *       ARGB_OnComplete(ARGB_RTOS_NotifyTask, xTaskGetCurrentTaskHandle());
+ *       render task: ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+ */
+
+#ifndef ARGB_RTOS_H_
+#define ARGB_RTOS_H_
+
+#include "ARGB.h"
+#include "FreeRTOS.h"
+#include "semphr.h"
+#include "task.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief ARGB_DoneFn: give the binary semaphore in ctx
+ * @param[in] strip Strip that finished a frame
+ * @param[in] ctx SemaphoreHandle_t
+ */
+static inline void ARGB_RTOS_GiveSemaphore(ARGB_Strip *strip, void *ctx) {
+    BaseType_t woken = pdFALSE;
+    (void) strip;
+    xSemaphoreGiveFromISR((SemaphoreHandle_t) ctx, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+/**
+ * @brief ARGB_DoneFn: notify the task in ctx (vTaskNotifyGiveFromISR)
+ * @param[in] strip Strip that finished a frame
+ * @param[in] ctx TaskHandle_t
+ */
+static inline void ARGB_RTOS_NotifyTask(ARGB_Strip *strip, void *ctx) {
+    BaseType_t woken = pdFALSE;
+    (void) strip;
+    vTaskNotifyGiveFromISR((TaskHandle_t) ctx, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+/**
+ * @brief Block until the strip is free, woken by ARGB_RTOS_GiveSemaphore
+ * @note Re-checks the strip after every give: a queued frame may already be on the wire
+ * @param[in] strip Strip handle
+ * @param[in] sem Semaphore registered with ARGB_OnComplete_Ex()
+ * @param[in] timeout Ticks per wait
+ * @return pdTRUE if the strip is free, pdFALSE on timeout
+ */
+static inline BaseType_t ARGB_RTOS_WaitReady(const ARGB_Strip *strip, SemaphoreHandle_t sem,
+                                             TickType_t timeout) {
+    while (ARGB_Ready_Ex(strip) != ARGB_READY) {
+        if (xSemaphoreTake(sem, timeout) != pdTRUE) return pdFALSE;
+    }
+    return pdTRUE;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ARGB_RTOS_H_ */
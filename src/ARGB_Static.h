@@ -0,0 +1,307 @@
+/**
+ *******************************************
+ * @file    ARGB_Static.h
+ * @brief   Compile-time C++ front end: ARGB::Strip<Pin, N, Led>
+ *******************************************
+ *
+ * @note Optional, not pulled in by ARGB.h. C++14, STM32F4xx, TIM1..TIM5.
+ *       Timer, channel, alternate function, DMA stream/channel, IRQ and PWM
+ *       slot width are resolved from constexpr tables while compiling: a pin
+ *       without a timer channel, or a channel without a DMA request (TIM4_CH4),
+ *       does not build. Storage is exactly N pixels of the LED type, slots as
+ *       wide as the timer's CCR. Same tables as ARGB_Auto.h, first DMA stream
+ *       of each channel.
+ *
+ * @note ARGB::Strip<ARGB::pin('A', 0), 60> strip;       // TIM2_CH1, DMA1 Stream5
+ *       ARGB::Strip<ARGB::pin('A', 0, 1), 60> strip;    // alternative timer: TIM5_CH1
+ *       extern "C" void DMA1_Stream5_IRQHandler(void) { strip.DMA_IRQHandler(); }
+ *       strip.Begin(); strip.SetRGB(0, 255, 0, 0); strip.Show();
+ *
+ * @note Pins are port * 16 + number, the STM32duino PinName numbering (PA_0,
+ *       PB_4...); +0x100 picks the second timer of PA0..PA3 (PA_0_ALT1).
+ *       Other _Ex functions take strip.Handle().
+ */
+
+#ifndef ARGB_STATIC_H_
+#define ARGB_STATIC_H_
+
+#include "ARGB.h"
+
+#if __cplusplus < 201402L
+#error ARGB_Static.h needs C++14
+#endif
+#if !defined(STM32F4xx) && !defined(ARGB_SIM)
+#error ARGB_Static.h: pin and DMA tables exist for STM32F4xx only
+#endif
+
+namespace ARGB {
+
+/**
+ * @brief Pin id for the Strip template
+ * @param[in] port 'A'..'E'
+ * @param[in] num 0..15
+ * @param[in] alt 1 - second timer of the pin (PA0..PA3: TIM5 instead of TIM2)
+ */
+constexpr u16_t pin(char port, u8_t num, u8_t alt = 0) {
+    return (u16_t) (((port - 'A') << 4) | (num & 0x0F) | (alt << 8));
+}
+
+/// LED types with their pixel size known while compiling, see #ARGB_LedType
+struct LedWS2811S { static constexpr u8_t bpp = 3; static const ARGB_LedType &type() { return ARGB_LED_WS2811S; } };
+struct LedWS2811F { static constexpr u8_t bpp = 3; static const ARGB_LedType &type() { return ARGB_LED_WS2811F; } };
+struct LedWS2812  { static constexpr u8_t bpp = 3; static const ARGB_LedType &type() { return ARGB_LED_WS2812; } };
+struct LedSK6812  { static constexpr u8_t bpp = 4; static const ARGB_LedType &type() { return ARGB_LED_SK6812; } };
+
+#if defined(SK6812)
+using LedDefault = LedSK6812;   ///< Family of the build
+#elif defined(WS2811S)
+using LedDefault = LedWS2811S;
+#elif defined(WS2811F)
+using LedDefault = LedWS2811F;
+#else
+using LedDefault = LedWS2812;
+#endif
+
+namespace detail {
+
+/// Timer channel on a pin
+struct PinTim {
+    u16_t pin;  ///< ARGB::pin()
+    u8_t tim;   ///< Timer number
+    u8_t ch;    ///< Channel 1..4
+};
+
+/// DMA request of a timer channel
+struct DmaReq {
+    u8_t tim;    ///< Timer number
+    u8_t ch;     ///< Channel 1..4
+    u8_t dma;    ///< Controller 1/2
+    u8_t stream; ///< Stream 0..7
+    u8_t req;    ///< DMA_CHANNEL_x number
+};
+
+// STM32F4 TIM1..TIM5 channels (datasheet alternate function map)
+constexpr PinTim PIN_MAP[] = {
+    {pin('A', 0), 2, 1}, {pin('A', 1), 2, 2}, {pin('A', 2), 2, 3}, {pin('A', 3), 2, 4},
+    {pin('A', 0, 1), 5, 1}, {pin('A', 1, 1), 5, 2}, {pin('A', 2, 1), 5, 3}, {pin('A', 3, 1), 5, 4},
+    {pin('A', 5), 2, 1}, {pin('A', 15), 2, 1}, {pin('B', 3), 2, 2}, {pin('B', 10), 2, 3}, {pin('B', 11), 2, 4},
+    {pin('A', 6), 3, 1}, {pin('A', 7), 3, 2}, {pin('B', 0), 3, 3}, {pin('B', 1), 3, 4},
+    {pin('B', 4), 3, 1}, {pin('B', 5), 3, 2},
+    {pin('C', 6), 3, 1}, {pin('C', 7), 3, 2}, {pin('C', 8), 3, 3}, {pin('C', 9), 3, 4},
+    {pin('A', 8), 1, 1}, {pin('A', 9), 1, 2}, {pin('A', 10), 1, 3}, {pin('A', 11), 1, 4},
+    {pin('E', 9), 1, 1}, {pin('E', 11), 1, 2}, {pin('E', 13), 1, 3}, {pin('E', 14), 1, 4},
+    {pin('B', 6), 4, 1}, {pin('B', 7), 4, 2}, {pin('B', 8), 4, 3}, {pin('B', 9), 4, 4},
+    {pin('D', 12), 4, 1}, {pin('D', 13), 4, 2}, {pin('D', 14), 4, 3}, {pin('D', 15), 4, 4},
+};
+
+// STM32F4 DMA request mapping (RM0090 Table 42/43), TIM4_CH4 has none
+constexpr DmaReq DMA_MAP[] = {
+    {1, 1, 2, 1, 6}, {1, 2, 2, 2, 6}, {1, 3, 2, 6, 6}, {1, 4, 2, 4, 6},
+    {2, 1, 1, 5, 3}, {2, 2, 1, 6, 3}, {2, 3, 1, 1, 3}, {2, 4, 1, 7, 3},
+    {3, 1, 1, 4, 5}, {3, 2, 1, 5, 5}, {3, 3, 1, 7, 5}, {3, 4, 1, 2, 5},
+    {4, 1, 1, 0, 2}, {4, 2, 1, 3, 2}, {4, 3, 1, 7, 2},
+    {5, 1, 1, 2, 6}, {5, 2, 1, 4, 6}, {5, 3, 1, 0, 6}, {5, 4, 1, 1, 6},
+};
+
+constexpr int find_pin(u16_t p) {
+    for (unsigned i = 0; i < sizeof(PIN_MAP) / sizeof(PIN_MAP[0]); i++)
+        if (PIN_MAP[i].pin == p) return (int) i;
+    return -1;
+}
+
+constexpr int find_dma(u8_t tim, u8_t ch) {
+    for (unsigned i = 0; i < sizeof(DMA_MAP) / sizeof(DMA_MAP[0]); i++)
+        if (DMA_MAP[i].tim == tim && DMA_MAP[i].ch == ch) return (int) i;
+    return -1;
+}
+
+/// Timer registers, the switch folds to one constant
+inline TIM_TypeDef *tim_instance(u8_t tim) {
+    switch (tim) {
+        case 1: return TIM1;
+        case 2: return TIM2;
+        case 3: return TIM3;
+        case 4: return TIM4;
+        default: return TIM5;
+    }
+}
+
+} // namespace detail
+
+/**
+ * @brief Strip on a fixed pin with storage for exactly N pixels
+ * @note Define at file scope (DMA-reachable RAM, not CCM). Begin() brings up
+ *       GPIO, timer and DMA, then ARGB_Attach_Ex() + ARGB_Init_Ex(): the core
+ *       driver does the rest, every ARGB_*_Ex() call works on Handle().
+ * @tparam Pin ARGB::pin() or STM32duino PinName
+ * @tparam N Pixels
+ * @tparam Led LedWS2811S / LedWS2811F / LedWS2812 / LedSK6812, default: the build family
+ */
+template <u16_t Pin, u16_t N, class Led = LedDefault>
+class Strip {
+    static constexpr int pin_i = detail::find_pin(Pin);
+    static_assert(pin_i >= 0, "ARGB::Strip: no TIM1..TIM5 channel on this pin");
+    static constexpr detail::PinTim pin_ = detail::PIN_MAP[pin_i < 0 ? 0 : pin_i];
+    static constexpr int dma_i = detail::find_dma(pin_.tim, pin_.ch);
+    static constexpr detail::DmaReq dma_ = detail::DMA_MAP[dma_i < 0 ? 0 : dma_i];
+    static_assert(dma_i >= 0, "ARGB::Strip: timer channel has no DMA request (TIM4_CH4)");
+    static_assert(N > 0 && (u32_t) N * Led::bpp <= 0xFFFF, "ARGB::Strip: 1..65535 RGB bytes");
+    static_assert(Led::bpp <= ARGB_MAX_BYTES_PER_PIXEL, "ARGB::Strip: RGBW needs ARGB_MAX_BYTES_PER_PIXEL 4");
+
+public:
+    static constexpr u8_t timer = pin_.tim;                        ///< TIMx
+    static constexpr u8_t channel = pin_.ch;                       ///< Channel 1..4
+    static constexpr u8_t af = timer <= 2 ? 1 : 2;                 ///< GPIO_AF1_TIM1/2, GPIO_AF2_TIM3/4/5
+    static constexpr u8_t dma = dma_.dma;                          ///< DMAx
+    static constexpr u8_t stream = dma_.stream;                    ///< DMAx_Streamy
+    static constexpr u8_t request = dma_.req;                      ///< DMA_CHANNEL_x
+    static constexpr u8_t pwm_width = timer == 2 || timer == 5 ? 4 : 2; ///< CCR width: MSIZE = PSIZE in direct mode
+#if ARGB_USE_STREAMING
+    static constexpr u32_t pwm_slots = ARGB_PWM_SLOTS(N);          ///< Two stream halves
+#else
+    static constexpr u32_t pwm_slots = (u32_t) N * Led::bpp * 8 + ARGB_RST_SLOTS; ///< Frame + reset
+#endif
+#ifndef ARGB_SIM
+    /// DMA stream interrupt: DMA1_Stream0..6 / 7, DMA2_Stream0..4 / 5..7 are not contiguous
+    static constexpr IRQn_Type dma_irqn = (IRQn_Type) (
+        dma == 1 ? (stream < 7 ? DMA1_Stream0_IRQn + stream : DMA1_Stream7_IRQn)
+                 : (stream < 5 ? DMA2_Stream0_IRQn + stream : DMA2_Stream5_IRQn + stream - 5));
+    /// Timer update interrupt, used by ARGB_USE_HW_LATCH
+    static constexpr IRQn_Type tim_irqn = timer == 1 ? TIM1_UP_TIM10_IRQn :
+                                          timer == 2 ? TIM2_IRQn : timer == 3 ? TIM3_IRQn :
+                                          timer == 4 ? TIM4_IRQn : TIM5_IRQn;
+#endif
+
+    Strip() : rgb_(), pwm_(), strip_(), htim_(), hdma_() {
+        // Same fields as ARGB_STRIP_DEF(), the rest starts zeroed
+        strip_.rgb_buf = rgb_;
+        strip_.pwm_buf = pwm_;
+        strip_.pwm_size = sizeof(pwm_);
+        strip_.rgb_size = sizeof(rgb_);
+        strip_.num_pixels = N;
+        strip_.led = &Led::type();
+#if ARGB_USE_DITHER
+        strip_.dith_buf = dith_;
+        strip_.dith_err = err_;
+#endif
+#if ARGB_QUEUE_COPY
+        strip_.q_buf = q_;
+#endif
+        strip_.br = 255;
+    }
+
+    Strip(const Strip &) = delete;
+    Strip &operator=(const Strip &) = delete;
+
+    /**
+     * @brief Clocks, GPIO, timer, DMA and NVIC of this pin, then attach and init the strip
+     * @return #ARGB_STATE enum
+     */
+    ARGB_STATE Begin() {
+        htim_.Instance = detail::tim_instance(timer);
+#ifndef ARGB_SIM
+        RCC->AHB1ENR |= (RCC_AHB1ENR_GPIOAEN << (Pin >> 4 & 0x0F)) |
+                        (dma == 1 ? RCC_AHB1ENR_DMA1EN : RCC_AHB1ENR_DMA2EN);
+        if (timer == 1) RCC->APB2ENR |= RCC_APB2ENR_TIM1EN;
+        else RCC->APB1ENR |= RCC_APB1ENR_TIM2EN << (timer - 2);
+        (void) RCC->APB1ENR; // Clock enable takes effect before the first access
+
+        GPIO_InitTypeDef gpio = {};
+        gpio.Pin = 1U << (Pin & 0x0F);
+        gpio.Mode = GPIO_MODE_AF_PP;
+        gpio.Pull = GPIO_NOPULL;
+        gpio.Speed = GPIO_SPEED_FREQ_HIGH;
+        gpio.Alternate = af;
+        HAL_GPIO_Init((GPIO_TypeDef *) (GPIOA_BASE + 0x400UL * (Pin >> 4 & 0x0F)), &gpio);
+
+        htim_.Init.Prescaler = 0;
+        htim_.Init.CounterMode = TIM_COUNTERMODE_UP;
+        htim_.Init.Period = 104; // ARGB_Init_Ex() sets the bit period
+        htim_.Init.ClockDivision = TIM_CLOCKDIVISION_DIV1;
+        HAL_TIM_PWM_Init(&htim_);
+        TIM_OC_InitTypeDef oc = {};
+        oc.OCMode = TIM_OCMODE_PWM1;
+        oc.OCPolarity = TIM_OCPOLARITY_HIGH;
+        HAL_TIM_PWM_ConfigChannel(&htim_, &oc, tim_channel());
+
+        hdma_.Instance = (DMA_Stream_TypeDef *) ((dma == 1 ? DMA1_Stream0_BASE : DMA2_Stream0_BASE) + 0x18UL * stream);
+        hdma_.Init.Channel = (u32_t) request << DMA_SxCR_CHSEL_Pos;
+        hdma_.Init.Direction = DMA_MEMORY_TO_PERIPH;
+        hdma_.Init.PeriphInc = DMA_PINC_DISABLE;
+        hdma_.Init.MemInc = DMA_MINC_ENABLE;
+        hdma_.Init.Priority = DMA_PRIORITY_HIGH;
+        hdma_.Init.FIFOMode = DMA_FIFOMODE_DISABLE;
+#endif
+        hdma_.Init.PeriphDataAlignment = pwm_width == 4 ? DMA_PDATAALIGN_WORD : DMA_PDATAALIGN_HALFWORD;
+        hdma_.Init.MemDataAlignment = pwm_width == 4 ? DMA_MDATAALIGN_WORD : DMA_MDATAALIGN_HALFWORD;
+        hdma_.Init.Mode = ARGB_USE_STREAMING ? DMA_CIRCULAR : DMA_NORMAL;
+        HAL_DMA_Init(&hdma_);
+        __HAL_LINKDMA(&htim_, hdma[channel == 1 ? TIM_DMA_ID_CC1 : channel == 2 ? TIM_DMA_ID_CC2 :
+                                   channel == 3 ? TIM_DMA_ID_CC3 : TIM_DMA_ID_CC4], hdma_);
+#ifndef ARGB_SIM
+        HAL_NVIC_SetPriority(dma_irqn, 1, 0);
+        HAL_NVIC_EnableIRQ(dma_irqn);
+#if ARGB_USE_HW_LATCH
+        HAL_NVIC_SetPriority(tim_irqn, 1, 0);
+        HAL_NVIC_EnableIRQ(tim_irqn);
+#endif
+#endif
+
+        const ARGB_STATE st = ARGB_Attach_Ex(&strip_, &htim_, tim_channel(), &hdma_, TimerClock());
+        return st == ARGB_OK ? ARGB_Init_Ex(&strip_) : st;
+    }
+
+#ifndef ARGB_SIM
+    /// Call from DMAx_Streamy_IRQHandler() (dma_irqn)
+    void DMA_IRQHandler() { HAL_DMA_IRQHandler(&hdma_); }
+#endif
+#if ARGB_USE_HW_LATCH
+    /// Call from the timer's IRQ handler (tim_irqn)
+    void TIM_IRQHandler() { ARGB_TIM_IRQHandler_Ex(&strip_); }
+#endif
+
+    ARGB_Strip *Handle() { return &strip_; }  ///< For the ARGB_*_Ex() functions
+    static constexpr u16_t Size() { return N; }
+
+    void SetBrightness(u8_t br) { ARGB_SetBrightness_Ex(&strip_, br); }
+    void SetRGB(u16_t i, u8_t r, u8_t g, u8_t b) { ARGB_SetRGB_Ex(&strip_, i, r, g, b); }
+    void SetHSV(u16_t i, u8_t hue, u8_t sat, u8_t val) { ARGB_SetHSV_Ex(&strip_, i, hue, sat, val); }
+    void SetWhite(u16_t i, u8_t w) { ARGB_SetWhite_Ex(&strip_, i, w); }
+    void FillRGB(u8_t r, u8_t g, u8_t b) { ARGB_FillRGB_Ex(&strip_, r, g, b); }
+    void FillHSV(u8_t hue, u8_t sat, u8_t val) { ARGB_FillHSV_Ex(&strip_, hue, sat, val); }
+    void FillWhite(u8_t w) { ARGB_FillWhite_Ex(&strip_, w); }
+    void Clear() { ARGB_Clear_Ex(&strip_); }
+    ARGB_STATE Show() { return ARGB_Show_Ex(&strip_); }
+    ARGB_STATE ShowPrefix() { return ARGB_ShowPrefix_Ex(&strip_); }
+    ARGB_STATE Ready() const { return ARGB_Ready_Ex(&strip_); }
+    void OnComplete(ARGB_DoneFn fn, void *ctx) { ARGB_OnComplete_Ex(&strip_, fn, ctx); }
+
+private:
+    static constexpr u32_t tim_channel() {
+        return channel == 1 ? TIM_CHANNEL_1 : channel == 2 ? TIM_CHANNEL_2 :
+               channel == 3 ? TIM_CHANNEL_3 : TIM_CHANNEL_4;
+    }
+
+    /// Timer input clock: APB2 for TIM1, APB1 otherwise, x2 when the bus is divided
+    static u32_t TimerClock() {
+        const u32_t pclk = timer == 1 ? HAL_RCC_GetPCLK2Freq() : HAL_RCC_GetPCLK1Freq();
+        return (RCC->CFGR & (timer == 1 ? RCC_CFGR_PPRE2 : RCC_CFGR_PPRE1)) ? pclk * 2 : pclk;
+    }
+
+    volatile u8_t rgb_[(u32_t) N * Led::bpp];
+    volatile u32_t pwm_[(pwm_slots * pwm_width + 3) / 4];
+#if ARGB_USE_DITHER
+    u16_t dith_[(u32_t) N * Led::bpp] = {};
+    u8_t err_[(u32_t) N * Led::bpp] = {};
+#endif
+#if ARGB_QUEUE_COPY
+    volatile u8_t q_[(u32_t) N * Led::bpp] = {};
+#endif
+    ARGB_Strip strip_;
+    TIM_HandleTypeDef htim_;
+    DMA_HandleTypeDef hdma_;
+};
+
+} // namespace ARGB
+
+#endif /* ARGB_STATIC_H_ */